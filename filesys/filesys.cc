@@ -50,6 +50,9 @@
 #include "directory.h"
 #include "filehdr.h"
 #include "filesys.h"
+#ifdef USER_PROGRAM
+#include "addrspace.h"
+#endif
 
 // Sectors containing the file headers for the bitmap of free sectors,
 // and the directory of files.  These file headers are placed in well-known 
@@ -245,6 +248,8 @@ FileSystem::Open(char *name)
 //	    Remove it from the directory
 //	    Delete the space for its header
 //	    Delete the space for its data blocks
+//	    Forget any cached image of it, since its header sector
+//	      may soon hold a different file
 //	    Write changes to directory, bitmap back to disk
 //
 //	Return TRUE if the file was deleted, FALSE if the file wasn't
@@ -277,6 +282,9 @@ FileSystem::Remove(char *name)
     fileHdr->Deallocate(freeMap);  		// remove data blocks
     freeMap->Clear(sector);			// remove header block
     directory->Remove(name);
+#ifdef USER_PROGRAM
+    ProgramImage::Forget(0, sector);		// the header sector is free
+#endif
 
     freeMap->WriteBack(freeMapFile);		// flush to disk
     directory->WriteBack(directoryFile);        // flush to disk
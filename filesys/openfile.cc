@@ -31,6 +31,7 @@ OpenFile::OpenFile(int sector)
 { 
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
+    hdrSector = sector;
     seekPosition = 0;
 }
 
@@ -98,8 +99,10 @@ OpenFile::Write(char *into, int numBytes)
 //	sector at a time.  Thus:
 //
 //	For ReadAt:
-//	   We read in all of the full or partial sectors that are part of the
-//	   request, but we only copy the part we are interested in.
+//	   We read the full sectors that are part of the request straight
+//	   into the caller's buffer.  A partial first or last sector is read
+//	   into a one-sector buffer, and only the part we are interested in
+//	   is copied.
 //	For WriteAt:
 //	   We must first read in any sectors that will be partially written,
 //	   so that we don't overwrite the unmodified portion.  We then copy
@@ -117,8 +120,8 @@ int
 OpenFile::ReadAt(char *into, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
-    char *buf;
+    int done, offset, chunk;
+    char buf[SectorSize];
 
     if ((numBytes <= 0) || (position >= fileLength))
     	return 0; 				// check request
@@ -127,19 +130,17 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
     DEBUG('f', "Reading %d bytes at %d, from file of length %d.\n", 	
 			numBytes, position, fileLength);
 
-    firstSector = divRoundDown(position, SectorSize);
-    lastSector = divRoundDown(position + numBytes - 1, SectorSize);
-    numSectors = 1 + lastSector - firstSector;
-
-    // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
-    for (i = firstSector; i <= lastSector; i++)	
-        synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-
-    // copy the part we want
-    bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete [] buf;
+    for (done = 0; done < numBytes; done += chunk) {
+	offset = (position + done) % SectorSize;
+	chunk = min(SectorSize - offset, numBytes - done);
+	if (chunk == SectorSize)		// a whole sector
+	    synchDisk->ReadSector(hdr->ByteToSector(position + done),
+					&into[done]);
+	else {					// copy the part we want
+	    synchDisk->ReadSector(hdr->ByteToSector(position + done), buf);
+	    bcopy(&buf[offset], &into[done], chunk);
+	}
+    }
     return numBytes;
 }
 
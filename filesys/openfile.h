@@ -52,6 +52,9 @@ class OpenFile {
 		}
 
     int Length() { Lseek(file, 0, 2); return Tell(file); }
+    void Identity(int *device, int *id) { FileId(file, device, id); }
+					// same for every OpenFile of
+					// this file
     
   private:
     int file;
@@ -85,9 +88,13 @@ class OpenFile {
 					// file (this interface is simpler 
 					// than the UNIX idiom -- lseek to 
 					// end of file, tell, lseek back 
+    void Identity(int *device, int *id) { *device = 0; *id = hdrSector; }
+					// same for every OpenFile of
+					// this file (there is one disk)
     
   private:
     FileHeader *hdr;			// Header for this file 
+    int hdrSector;			// where the header is, on disk
     int seekPosition;			// Current position within the file
 };
 
@@ -23,12 +23,14 @@
 #include "copyright.h"
 #include "interrupt.h"
 #include "system.h"
+#include "schedpolicy.h"
 
 // String definitions for debugging messages
 
 static char *intLevelNames[] = { "off", "on"};
 static char *intTypeNames[] = { "timer", "disk", "console write", 
-			"console read", "network send", "network recv"};
+			"console read", "network send", "network recv",
+			"alarm"};
 
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
@@ -48,6 +50,188 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
     arg = param;
     when = time;
     type = kind;
+    index = -1;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::EventQueue
+// 	Initialize an empty queue of pending interrupts.
+//----------------------------------------------------------------------
+
+EventQueue::EventQueue()
+{
+    capacity = 16;
+    heap = new PendingInterrupt*[capacity];
+    size = 0;
+    freeList = NULL;
+    nextSeq = 0;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::~EventQueue
+// 	De-allocate the queue, along with any interrupts still queued
+//	and the records on the free list.
+//----------------------------------------------------------------------
+
+EventQueue::~EventQueue()
+{
+    PendingInterrupt *pend;
+
+    while (size > 0)
+	delete heap[--size];
+    while ((pend = freeList) != NULL) {
+	freeList = pend->nextFree;
+	delete pend;
+    }
+    delete [] heap;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Allocate
+// 	Return a PendingInterrupt record set up with the given fields,
+//	taken from the free list if possible.
+//
+//	"func", "param", "time", "kind" -- as for PendingInterrupt
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+EventQueue::Allocate(VoidFunctionPtr func, int param, int time, IntType kind)
+{
+    PendingInterrupt *pend = freeList;
+
+    if (pend == NULL)
+	return new PendingInterrupt(func, param, time, kind);
+    freeList = pend->nextFree;
+    pend->handler = func;
+    pend->arg = param;
+    pend->when = time;
+    pend->type = kind;
+    return pend;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Free
+// 	Put a PendingInterrupt record, no longer queued, back in the pool.
+//----------------------------------------------------------------------
+
+void
+EventQueue::Free(PendingInterrupt *pend)
+{
+    pend->nextFree = freeList;
+    freeList = pend;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Insert
+// 	Queue an interrupt to fire at pend->when, after any already queued
+//	for the same time.  Sift it up from the bottom of the heap.
+//----------------------------------------------------------------------
+
+void
+EventQueue::Insert(PendingInterrupt *pend)
+{
+    int i;
+
+    if (size == capacity) {		// out of room, double the heap
+	PendingInterrupt **bigger = new PendingInterrupt*[2 * capacity];
+
+	for (i = 0; i < size; i++)
+	    bigger[i] = heap[i];
+	delete [] heap;
+	heap = bigger;
+	capacity *= 2;
+    }
+    pend->seq = nextSeq++;
+    Sift(pend, size++);
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Sift
+// 	Fill the hole at heap[i] with "pend": move it up past any parents
+//	due after it, or else down past any children due before it.
+//----------------------------------------------------------------------
+
+void
+EventQueue::Sift(PendingInterrupt *pend, int i)
+{
+    int parent, child;
+
+    for (; i > 0; i = parent) {
+	parent = (i - 1) / 2;
+	if (!Earlier(pend, heap[parent]))
+	    break;
+	Place(heap[parent], i);
+    }
+    for (; (child = 2 * i + 1) < size; i = child) {
+	if ((child + 1 < size) && Earlier(heap[child + 1], heap[child]))
+	    child++;
+	if (!Earlier(heap[child], pend))
+	    break;
+	Place(heap[child], i);
+    }
+    Place(pend, i);
+}
+
+//----------------------------------------------------------------------
+// EventQueue::RemoveTop
+// 	Dequeue and return the earliest interrupt, or NULL if there are
+//	none.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+EventQueue::RemoveTop()
+{
+    PendingInterrupt *top;
+
+    if (size == 0)
+	return NULL;
+    top = heap[0];
+    Remove(top);
+    return top;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Remove
+// 	Dequeue "pend", which must be queued.  The last element of the
+//	heap takes its place, and is sifted to where it belongs.
+//----------------------------------------------------------------------
+
+void
+EventQueue::Remove(PendingInterrupt *pend)
+{
+    PendingInterrupt *last;
+
+    ASSERT(pend->index >= 0 && pend->index < size && heap[pend->index] == pend);
+    last = heap[--size];
+    if (last != pend)
+	Sift(last, pend->index);
+    pend->index = -1;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Mapcar
+// 	Apply a function to each queued interrupt, earliest first, by
+//	sorting a copy of the heap.  Only used for debugging output.
+//
+//	"func" is the procedure to apply; it is passed the PendingInterrupt
+//----------------------------------------------------------------------
+
+void
+EventQueue::Mapcar(VoidFunctionPtr func)
+{
+    PendingInterrupt **sorted = new PendingInterrupt*[size + 1];
+    PendingInterrupt *pend;
+    int i, j;
+
+    for (i = 0; i < size; i++) {	// insertion sort; the heap is small
+	pend = heap[i];			// whenever anyone is looking at it
+	for (j = i; (j > 0) && Earlier(pend, sorted[j - 1]); j--)
+	    sorted[j] = sorted[j - 1];
+	sorted[j] = pend;
+    }
+    for (i = 0; i < size; i++)
+	(*func)((int) sorted[i]);
+    delete [] sorted;
 }
 
 //----------------------------------------------------------------------
@@ -60,7 +244,7 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new List();
+    pending = new EventQueue();
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -73,8 +257,6 @@ Interrupt::Interrupt()
 
 Interrupt::~Interrupt()
 {
-    while (!pending->IsEmpty())
-	delete pending->Remove();
     delete pending;
 }
 
@@ -174,10 +356,31 @@ Interrupt::OneTick()
 	yieldOnReturn = FALSE;
  	status = SystemMode;		// yield is a kernel routine
 	currentThread->Yield();
+#ifdef USER_PROGRAM
+	if (old == UserMode)		// back to user code, unless the
+	    ExitIfKilled();		// process was killed meanwhile
+#endif
 	status = old;
     }
 }
 
+//----------------------------------------------------------------------
+// Interrupt::NextDueTime
+// 	Return the time at which the earliest pending interrupt is due,
+//	without firing or removing it.  Lets the machine simulation know
+//	how many ticks it can run before OneTick would have work to do.
+//----------------------------------------------------------------------
+
+int
+Interrupt::NextDueTime()
+{
+    PendingInterrupt *next = pending->Top();
+
+    if (next == NULL)
+	return NeverDue;
+    return next->when;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::YieldOnReturn
 // 	Called from within an interrupt handler, to cause a context switch
@@ -242,6 +445,7 @@ Interrupt::Halt()
 {
     printf("Machine halting!\n\n");
     stats->Print();
+    scheduler->Policy()->PrintStats();
     Cleanup();     // Never returns.
 }
 
@@ -260,18 +464,38 @@ Interrupt::Halt()
 //	"fromNow" is how far in the future (in simulated time) the 
 //		 interrupt is to occur
 //	"type" is the hardware device that generated the interrupt
+//
+//	Returns a handle for Cancel, good until the interrupt fires.
 //----------------------------------------------------------------------
-void
+PendingInterrupt *
 Interrupt::Schedule(VoidFunctionPtr handler, int arg, int fromNow, IntType type)
 {
     int when = stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(handler, arg, when, type);
+    PendingInterrupt *toOccur = pending->Allocate(handler, arg, when, type);
 
     DEBUG('i', "Scheduling interrupt handler the %s at time = %d\n", 
 					intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    pending->Insert(toOccur);
+    return toOccur;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::Cancel
+// 	Take back an interrupt that has been scheduled but hasn't fired,
+//	so that a device that no longer needs it (like a timer with
+//	nothing to time) doesn't keep the machine busy.
+//
+//	"pend" is what Schedule returned for the interrupt
+//----------------------------------------------------------------------
+void
+Interrupt::Cancel(PendingInterrupt *pend)
+{
+    DEBUG('i', "Cancelling interrupt handler the %s at time = %d\n", 
+					intTypeNames[pend->type], pend->when);
+    pending->Remove(pend);
+    pending->Free(pend);
 }
 
 //----------------------------------------------------------------------
@@ -297,24 +521,23 @@ Interrupt::CheckIfDue(bool advanceClock)
 					// to invoke an interrupt handler
     if (DebugIsEnabled('i'))
 	DumpState();
-    PendingInterrupt *toOccur = 
-		(PendingInterrupt *)pending->SortedRemove(&when);
-
-    if (toOccur == NULL)		// no pending interrupts
+    when = NextDueTime();
+    if (when == NeverDue)		// no pending interrupts
 	return FALSE;			
+    if (!advanceClock && when > stats->totalTicks)	// not time yet
+	return FALSE;
 
-    if (advanceClock && when > stats->totalTicks) {	// advance the clock
+    PendingInterrupt *toOccur = pending->RemoveTop();
+
+    if (when > stats->totalTicks) {	// advance the clock
 	stats->idleTicks += (when - stats->totalTicks);
 	stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {	// not time yet, put it back
-	pending->SortedInsert(toOccur, when);
-	return FALSE;
     }
 
 // Check if there is nothing more to do, and if so, quit
     if ((status == IdleMode) && (toOccur->type == TimerInt) 
 				&& pending->IsEmpty()) {
-	 pending->SortedInsert(toOccur, when);
+	 pending->Insert(toOccur);
 	 return FALSE;
     }
 
@@ -331,7 +554,7 @@ Interrupt::CheckIfDue(bool advanceClock)
     (*(toOccur->handler))(toOccur->arg);	// call the interrupt handler
     status = old;				// restore the machine status
     inHandler = FALSE;
-    delete toOccur;
+    pending->Free(toOccur);
     return TRUE;
 }
 
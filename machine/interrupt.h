@@ -50,7 +50,7 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 // In Nachos, we support a hardware timer device, a disk, a console
 // display and keyboard, and a network.
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt, 
-				NetworkSendInt, NetworkRecvInt};
+				NetworkSendInt, NetworkRecvInt, AlarmInt};
 
 // The following class defines an interrupt that is scheduled
 // to occur in the future.  The internal data structures are
@@ -67,6 +67,62 @@ class PendingInterrupt {
     int arg;                    // The argument to the function.
     int when;			// When the interrupt is supposed to fire
     IntType type;		// for debugging
+    unsigned int seq;		// order of scheduling, so that interrupts
+				// due at the same time fire first-come, 
+				// first-served
+    PendingInterrupt *nextFree;	// link on the EventQueue free list
+    int index;			// where it is in the EventQueue heap,
+				// or -1 if it isn't queued
+};
+
+// The following class defines the queue of pending interrupts: a
+// binary min-heap ordered by (when, seq), so that scheduling and
+// firing an interrupt are O(log n) and finding the next deadline is
+// O(1), no matter how many devices have interrupts outstanding.
+//
+// PendingInterrupts come from, and go back to, a free list kept by
+// the queue, so a steady stream of device interrupts doesn't call 
+// new and delete at all once the queue has warmed up.
+
+class EventQueue {
+  public:
+    EventQueue();			// initialize an empty queue
+    ~EventQueue();			// de-allocate the queue and its pool
+
+    PendingInterrupt *Allocate(VoidFunctionPtr func, int param, 
+				int time, IntType kind);
+					// get an unqueued interrupt record
+    void Free(PendingInterrupt *pend);	// return one to the pool
+
+    void Insert(PendingInterrupt *pend);  // queue an interrupt
+    PendingInterrupt *Top() { return (size > 0) ? heap[0] : NULL; }
+					// earliest interrupt, or NULL
+    PendingInterrupt *RemoveTop();	// dequeue the earliest interrupt
+    void Remove(PendingInterrupt *pend);	// dequeue "pend", wherever
+					// it is
+    bool IsEmpty() { return (size == 0); }
+
+    void Mapcar(VoidFunctionPtr func);	// apply "func" to every queued
+					// interrupt, in firing order
+
+  private:
+    PendingInterrupt **heap;		// heap[0] is the earliest
+    int size;				// number of queued interrupts
+    int capacity;			// number of slots in "heap"
+    PendingInterrupt *freeList;		// pool of unused records
+    unsigned int nextSeq;		// "seq" for the next Insert
+
+    void Place(PendingInterrupt *pend, int i) {
+	heap[i] = pend;
+	pend->index = i;
+    }
+    void Sift(PendingInterrupt *pend, int i);	// put "pend" in the hole
+					// at heap[i], moving it up or down
+
+    bool Earlier(PendingInterrupt *a, PendingInterrupt *b) {
+	return (a->when < b->when) || 
+		((a->when == b->when) && ((int) (a->seq - b->seq) < 0));
+    }
 };
 
 // The following class defines the data structures for the simulation
@@ -74,6 +130,8 @@ class PendingInterrupt {
 // or disabled, and any hardware interrupts that are scheduled to occur
 // in the future.
 
+#define NeverDue	0x7fffffff	// NextDueTime, when nothing is pending
+
 class Interrupt {
   public:
     Interrupt();			// initialize the interrupt simulation
@@ -106,16 +164,22 @@ class Interrupt {
     // but they need to be public since they are called by the
     // hardware device simulators.
 
-    void Schedule(VoidFunctionPtr handler,// Schedule an interrupt to occur
-	int arg, int when, IntType type);// at time ``when''.  This is called
+    PendingInterrupt *Schedule(VoidFunctionPtr handler,
+	int arg, int when, IntType type);// Schedule an interrupt to occur
+    					// at time ``when''.  This is called
     					// by the hardware device simulators.
+    void Cancel(PendingInterrupt *pend);// Take back an interrupt returned
+					// by Schedule that hasn't fired yet
     
     void OneTick();       		// Advance simulated time
 
+    int NextDueTime();			// When the earliest pending interrupt
+					// is due, or NeverDue if none is
+
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    List *pending;		// the list of interrupts scheduled
-				// to occur in the future
+    EventQueue *pending;	// the interrupts scheduled to occur
+				// in the future
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
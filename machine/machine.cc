@@ -50,16 +50,23 @@ void CheckEndian()
 //
 //	"debug" -- if TRUE, drop into the debugger after each user instruction
 //		is executed.
+//	"threadedCode" -- if TRUE, run straight-line user code a basic 
+//		block at a time (see RunBlock).  Ignored when tracing
+//		instructions or interrupts.
+//	"physPages" -- the number of physical page frames
 //----------------------------------------------------------------------
 
-Machine::Machine(bool debug)
+Machine::Machine(bool debug, bool threadedCode, int physPages)
 {
     int i;
 
     for (i = 0; i < NumTotalRegs; i++)
         registers[i] = 0;
-    mainMemory = new char[MemorySize];
-    for (i = 0; i < MemorySize; i++)
+    ASSERT(physPages > 0);
+    numPhysPages = physPages;
+    memorySize = numPhysPages * PageSize;
+    mainMemory = new char[memorySize];
+    for (i = 0; i < memorySize; i++)
       	mainMemory[i] = 0;
 #ifdef USE_TLB
     tlb = new TranslationEntry[TLBSize];
@@ -71,6 +78,23 @@ Machine::Machine(bool debug)
     pageTable = NULL;
 #endif
 
+    decodeCache = new DecodedPage*[numPhysPages];
+    for (i = 0; i < numPhysPages; i++)
+	decodeCache[i] = NULL;
+    useHostTLB = !DebugIsEnabled('a');
+    FlushHostTLB();
+
+    eventHorizon = !DebugIsEnabled('i');	// tracing must see every tick
+    threaded = threadedCode && eventHorizon && !DebugIsEnabled('m');
+    blockHash = new BasicBlock*[BlockHashSize];
+    for (i = 0; i < BlockHashSize; i++)
+	blockHash[i] = NULL;
+    frameBlocks = new BasicBlock*[numPhysPages];
+    for (i = 0; i < numPhysPages; i++)
+	frameBlocks[i] = NULL;
+    deadBlocks = NULL;
+    blockTicks = 0;
+
     singleStep = debug;
     CheckEndian();
 }
@@ -85,6 +109,101 @@ Machine::~Machine()
     delete [] mainMemory;
     if (tlb != NULL)
         delete [] tlb;
+    for (int i = 0; i < numPhysPages; i++)
+	InvalidateFrame(i);		// uses decodeCache, so first
+    FreeDeadBlocks();
+    for (int i = 0; i < numPhysPages; i++)
+	delete decodeCache[i];
+    delete [] decodeCache;
+    delete [] frameBlocks;
+    delete [] blockHash;
+}
+
+//----------------------------------------------------------------------
+// DecodedPage::DecodedPage, DecodedPage::Invalidate
+// 	Set up, or empty out, the decoded instructions cached for one
+//	physical page frame.
+//----------------------------------------------------------------------
+
+DecodedPage::DecodedPage()
+{
+    anyValid = TRUE;		// so that Invalidate clears every slot
+    Invalidate();
+}
+
+void
+DecodedPage::Invalidate()
+{
+    if (!anyValid)
+	return;
+    for (int i = 0; i < InstrsPerPage; i++)
+	valid[i] = FALSE;
+    anyValid = FALSE;
+}
+
+//----------------------------------------------------------------------
+// Machine::FlushHostTLB
+// 	Empty the host-side translation cache, so every page is checked by
+//	Translate again the next time it is touched.
+//----------------------------------------------------------------------
+
+void
+Machine::FlushHostTLB()
+{
+    for (int i = 0; i < HostTLBSize; i++)
+	hostTLB[i].page = NULL;
+}
+
+//----------------------------------------------------------------------
+// Machine::InvalidateFrame
+// 	Throw away any decoded instructions for physical page "frame",
+//	including the basic blocks that start there.
+//	Called on every user store into a frame that holds decoded code,
+//	and by the kernel whenever it hands a frame to a new owner or
+//	otherwise changes its contents behind the simulator's back.
+//
+//	A store can invalidate the very block that is running, so blocks
+//	are only marked invalid and unhooked here; RunBlock deletes them
+//	(FreeDeadBlocks) before it starts the next one.
+//----------------------------------------------------------------------
+
+void
+Machine::InvalidateFrame(int frame)
+{
+    BasicBlock *block, **prev;
+
+    ASSERT((frame >= 0) && (frame < numPhysPages));
+    if ((decodeCache[frame] != NULL) && decodeCache[frame]->anyValid) {
+	decodeCache[frame]->Invalidate();
+	stats->numDecodeInvalidations++;
+    }
+    while ((block = frameBlocks[frame]) != NULL) {
+	frameBlocks[frame] = block->frameNext;
+	prev = &blockHash[(block->physAddr >> 2) & (BlockHashSize - 1)];
+	while (*prev != block)
+	    prev = &(*prev)->hashNext;
+	*prev = block->hashNext;
+	block->valid = FALSE;
+	block->frameNext = deadBlocks;
+	deadBlocks = block;
+    }
+}
+
+//----------------------------------------------------------------------
+// Machine::FreeDeadBlocks
+// 	Delete the basic blocks invalidated since the last call.  Only
+//	safe when no block is in the middle of running.
+//----------------------------------------------------------------------
+
+void
+Machine::FreeDeadBlocks()
+{
+    BasicBlock *block;
+
+    while ((block = deadBlocks) != NULL) {
+	deadBlocks = block->frameNext;
+	delete block;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -103,6 +222,14 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
     DEBUG('m', "Exception: %s\n", exceptionNames[which]);
     
 //  ASSERT(interrupt->getStatus() == UserMode);
+    // charge for the instructions of the running basic block that
+    // completed before this one trapped, so the kernel sees the time
+    // just as if they had been run one at a time
+    if (blockTicks > 0) {
+	stats->totalTicks += blockTicks * UserTick;
+	stats->userTicks += blockTicks * UserTick;
+	blockTicks = 0;
+    }
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);			// finish anything in progress
     interrupt->setStatus(SystemMode);
@@ -32,9 +32,12 @@
 					// the disk sector size, for
 					// simplicity
 
-#define NumPhysPages    32
-#define MemorySize 	(NumPhysPages * PageSize)
+#define DefaultPhysPages 32		// physical page frames, unless the
+					// -mem option asks for more (the
+					// number actually present is
+					// Machine::numPhysPages)
 #define TLBSize		4		// if there is a TLB, make it small
+#define InstrsPerPage	(PageSize / 4)	// instruction words per page frame
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -91,6 +94,78 @@ class Instruction {
                      // Immediates are sign-extended.
 };
 
+// The following class caches the decoded form of the instruction words
+// in one physical page frame.  A slot is filled the first time the
+// instruction at that address is fetched, and the whole page is thrown
+// away whenever the frame is written, so that code which is executed
+// over and over is only fetched from memory and decoded once.
+
+class DecodedPage {
+  public:
+    DecodedPage();		// all slots start out empty
+    void Invalidate();		// forget every decoded instruction
+
+    Instruction instr[InstrsPerPage];	// decoded instructions
+    bool valid[InstrsPerPage];		// is instr[i] up to date?
+    bool anyValid;			// is any slot in use?  Lets writes
+					// to data-only frames skip Invalidate
+};
+
+// The following class defines an entry in the host-side translation
+// cache.  It sits in front of Machine::Translate: once a virtual page
+// has been translated successfully, further loads (and, once a store
+// has gone through Translate and set the dirty bit, stores) to that
+// page go straight to its frame in mainMemory after a tag compare.
+//
+// The cache knows nothing about the page table or TLB it was filled
+// from, so the kernel must call Machine::FlushHostTLB whenever it
+// switches address spaces or changes a TranslationEntry that might
+// be cached (valid, readOnly, physicalPage, or clearing use/dirty).
+
+#define HostTLBSize	64	// entries in the host translation cache;
+				// must be a power of two
+
+class HostTLBEntry {
+  public:
+    unsigned int vpn;		// the virtual page cached here
+    char *page;			// the start of its frame, or NULL if the
+				// entry is empty
+    bool writable;		// can stores skip Translate too?
+};
+
+// The following classes define the basic blocks used by the threaded-code
+// execution engine (see Machine::RunBlock).  A basic block is a run of
+// straight-line code starting at a given physical address and ending
+// after a branch and its delay slot, after an instruction that always
+// traps, or at the end of the page frame -- so a block never spans two
+// frames, and can be thrown away with the rest of the frame's decoded
+// instructions.  Each instruction carries a pointer to a specialized
+// handler, or NULL to go through the general interpreter.
+
+class Machine;
+typedef void (*FastOpHandler)(Machine *machine, Instruction *instr);
+
+class ThreadedOp {
+  public:
+    FastOpHandler handler;	// NULL if ExecuteInstruction must be used
+    Instruction instr;		// the decoded instruction
+};
+
+class BasicBlock {
+  public:
+    int physAddr;		// physical address of the first instruction
+    int length;			// number of instructions in the block
+    bool valid;			// FALSE once the frame has been changed
+    ThreadedOp ops[InstrsPerPage];
+    BasicBlock *hashNext;	// next block in the same hash bucket
+    BasicBlock *frameNext;	// next block in the same frame
+};
+
+#define BlockHashSize	1024	// buckets in the basic block hash table
+
+enum BlockResult { BlockNotRun, BlockDone, BlockTrapped };
+				// what Machine::RunBlock did
+
 // The following class defines the simulated host workstation hardware, as 
 // seen by user programs -- the CPU registers, main memory, etc.
 // User programs shouldn't be able to tell that they are running on our 
@@ -106,8 +181,11 @@ class Instruction {
 
 class Machine {
   public:
-    Machine(bool debug);	// Initialize the simulation of the hardware
-				// for running user programs
+    Machine(bool debug, bool threadedCode, int physPages);
+				// Initialize the simulation of the hardware
+				// for running user programs; "threadedCode"
+				// selects the basic-block execution engine,
+				// "physPages" the size of main memory
     ~Machine();			// De-allocate the data structures
 
 // Routines callable by the Nachos kernel
@@ -115,14 +193,29 @@ class Machine {
 
     int ReadRegister(int num);	// read the contents of a CPU register
 
+    void FlushHostTLB();	// Forget all cached host translations;
+				// see HostTLBEntry above
+
     void WriteRegister(int num, int value);
 				// store a value into a CPU register
 
 
 // Routines internal to the machine simulation -- DO NOT call these 
 
-    void OneInstruction(Instruction *instr); 	
-    				// Run one instruction of a user program.
+    bool OneInstruction(); 	// Run one instruction of a user program;
+				// returns FALSE if it raised an exception
+    void RunUntilDue();		// Run instructions until the next pending
+				// interrupt is due, then fire it
+    bool ExecuteInstruction(Instruction *instr);
+    				// Execute one decoded instruction; returns
+				// FALSE if it raised an exception
+    BlockResult RunBlock(int due);
+				// Run the basic block at the PC, if it
+				// will finish before time "due"
+    Instruction *FetchInstruction(int pc);
+    				// Return the decoded instruction at "pc",
+				// from the decode cache if possible.  
+				// Returns NULL if an exception occurred.
     void DelayedLoad(int nextReg, int nextVal);  	
 				// Do a pending delayed load (modifying a reg)
     
@@ -139,6 +232,11 @@ class Machine {
     				// and return an exception code if the 
 				// translation couldn't be completed.
 
+    void InvalidateFrame(int frame);
+    				// Discard any decoded instructions cached
+				// for a physical page frame; must be called
+				// whenever the kernel changes its contents.
+
     void RaiseException(ExceptionType which, int badVAddr);
 				// Trap to the Nachos kernel, because of a
 				// system call or other exception.  
@@ -156,6 +254,8 @@ class Machine {
     char *mainMemory;		// physical memory to store user program,
 				// code and data, while executing
     int registers[NumTotalRegs]; // CPU registers, for executing user programs
+    int numPhysPages;		// number of page frames in mainMemory
+    int memorySize;		// and its size in bytes
 
 
 // NOTE: the hardware translation of virtual addresses in the user program
@@ -187,12 +287,46 @@ class Machine {
 				// simulated instruction
     int runUntilTime;		// drop back into the debugger when simulated
 				// time reaches this value
+
+    DecodedPage **decodeCache;	// per physical frame, decoded instructions
+				// (NULL until code is run from the frame)
+    HostTLBEntry hostTLB[HostTLBSize];	// host-side translation cache
+    bool useHostTLB;		// FALSE when tracing translations
+
+    char *HostLookup(int addr, int size, bool writing) {
+	HostTLBEntry *e = &hostTLB[((unsigned) addr / PageSize) 
+					& (HostTLBSize - 1)];
+	if ((e->page == NULL) || (e->vpn != (unsigned) addr / PageSize)
+		|| (addr & (size - 1)) || (writing && !e->writable))
+	    return NULL;
+	return e->page + (unsigned) addr % PageSize;
+    }				// Where "addr" is in mainMemory, or NULL
+				// if it must go through Translate
+    void HostFill(int virtAddr, int physAddr, bool writing);
+				// Cache a translation Translate just made
+
+    bool eventHorizon;		// tick in batches between interrupts?
+    bool threaded;		// use the basic-block engine?
+    BasicBlock **blockHash;	// compiled blocks, by physical address
+    BasicBlock **frameBlocks;	// per physical frame, blocks starting there
+    BasicBlock *deadBlocks;	// invalidated blocks, not yet deleted
+    int blockTicks;		// instructions of the running block whose
+				// ticks have not been charged yet
+
+    bool FetchHit(int pc, int *physAddr);
+				// Translate "pc" without Translate, if the
+				// host translation cache allows
+    BasicBlock *CompileBlock(int physAddr);
+				// Decode the block starting at "physAddr"
+    void FreeDeadBlocks();	// Delete blocks invalidated since last time
 };
 
 extern void ExceptionHandler(ExceptionType which);
 				// Entry point into Nachos for handling
 				// user system calls and exceptions
 				// Defined in exception.cc
+extern void ExitIfKilled();	// End the current process, if it has
+				// been killed; also in exception.cc
 
 
 // Routines for converting Words and Short Words to and from the
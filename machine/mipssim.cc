@@ -30,20 +30,430 @@ static void Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr);
 void
 Machine::Run()
 {
-    Instruction *instr = new Instruction;  // storage for decoded instruction
-
     if(DebugIsEnabled('m'))
         printf("Starting thread \"%s\" at time %d\n",
 	       currentThread->getName(), stats->totalTicks);
     interrupt->setStatus(UserMode);
     for (;;) {
-        OneInstruction(instr);
+	if (!singleStep && eventHorizon) {
+	    RunUntilDue();
+	    continue;
+	}
+        OneInstruction();
 	interrupt->OneTick();
 	if (singleStep && (runUntilTime <= stats->totalTicks))
 	  Debugger();
     }
 }
 
+//----------------------------------------------------------------------
+// Machine::RunUntilDue
+// 	Run user instructions up to the next pending interrupt, then
+//	call OneTick once to fire whatever is due.
+//
+//	Between interrupts, OneTick does nothing but advance the clock,
+//	so for every instruction whose tick still falls before the next
+//	interrupt we just charge the tick ourselves.  The pending
+//	interrupts can only change inside OneTick or the kernel, so the
+//	deadline is computed once, and we go back to Run (after the
+//	OneTick for the trapping instruction) as soon as anything traps.
+//	The total and user tick counts come out exactly as if OneTick
+//	had been called after every instruction.
+//----------------------------------------------------------------------
+
+void
+Machine::RunUntilDue()
+{
+    int due = interrupt->NextDueTime();
+
+    while (stats->totalTicks + UserTick < due) {
+	if (threaded) {
+	    BlockResult result = RunBlock(due);
+
+	    if (result == BlockDone)
+		continue;
+	    if (result == BlockTrapped) {
+		interrupt->OneTick();
+		return;
+	    }
+	}
+	if (!OneInstruction()) {
+	    interrupt->OneTick();
+	    return;
+	}
+	stats->totalTicks += UserTick;
+	stats->userTicks += UserTick;
+    }
+    OneInstruction();
+    interrupt->OneTick();
+}
+
+//----------------------------------------------------------------------
+// Fast handlers for the basic-block engine
+// 	One routine per simple ALU instruction -- those that can never
+//	trap, branch or load.  Each must have exactly the effect of the
+//	matching case in ExecuteInstruction, including its quirks (SRL
+//	shifts a signed value), followed by FinishOp.  Everything else
+//	(loads, stores, branches, multiply and divide, trapping
+//	arithmetic, and OR) goes through ExecuteInstruction.
+//----------------------------------------------------------------------
+
+static inline void
+FinishOp(Machine *m)
+{
+    int *regs = m->registers;
+
+    regs[regs[LoadReg]] = regs[LoadValueReg];	// DelayedLoad(0, 0)
+    regs[LoadReg] = 0;
+    regs[LoadValueReg] = 0;
+    regs[0] = 0;
+    regs[PrevPCReg] = regs[PCReg];
+    regs[PCReg] = regs[NextPCReg];
+    regs[NextPCReg] += 4;
+}
+
+static void
+FastADDIU(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = m->registers[instr->rs] + instr->extra;
+    FinishOp(m);
+}
+
+static void
+FastADDU(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] + m->registers[instr->rt];
+    FinishOp(m);
+}
+
+static void
+FastAND(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] & m->registers[instr->rt];
+    FinishOp(m);
+}
+
+static void
+FastANDI(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = m->registers[instr->rs] & (instr->extra & 0xffff);
+    FinishOp(m);
+}
+
+static void
+FastLUI(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = instr->extra << 16;
+    FinishOp(m);
+}
+
+static void
+FastMFHI(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[HiReg];
+    FinishOp(m);
+}
+
+static void
+FastMFLO(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[LoReg];
+    FinishOp(m);
+}
+
+static void
+FastMTHI(Machine *m, Instruction *instr)
+{
+    m->registers[HiReg] = m->registers[instr->rs];
+    FinishOp(m);
+}
+
+static void
+FastMTLO(Machine *m, Instruction *instr)
+{
+    m->registers[LoReg] = m->registers[instr->rs];
+    FinishOp(m);
+}
+
+static void
+FastNOR(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = 
+		~(m->registers[instr->rs] | m->registers[instr->rt]);
+    FinishOp(m);
+}
+
+static void
+FastORI(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = m->registers[instr->rs] | (instr->extra & 0xffff);
+    FinishOp(m);
+}
+
+static void
+FastSLL(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rt] << instr->extra;
+    FinishOp(m);
+}
+
+static void
+FastSLLV(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rt] <<
+	(m->registers[instr->rs] & 0x1f);
+    FinishOp(m);
+}
+
+static void
+FastSLT(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = 
+		(m->registers[instr->rs] < m->registers[instr->rt]) ? 1 : 0;
+    FinishOp(m);
+}
+
+static void
+FastSLTI(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = (m->registers[instr->rs] < instr->extra) ? 1 : 0;
+    FinishOp(m);
+}
+
+static void
+FastSLTIU(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = ((unsigned int) m->registers[instr->rs] 
+				< (unsigned int) instr->extra) ? 1 : 0;
+    FinishOp(m);
+}
+
+static void
+FastSLTU(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = ((unsigned int) m->registers[instr->rs] 
+				< (unsigned int) m->registers[instr->rt]) ? 1 : 0;
+    FinishOp(m);
+}
+
+static void
+FastSRA(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rt] >> instr->extra;
+    FinishOp(m);
+}
+
+static void
+FastSRAV(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rt] >>
+	(m->registers[instr->rs] & 0x1f);
+    FinishOp(m);
+}
+
+static void
+FastSUBU(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] - m->registers[instr->rt];
+    FinishOp(m);
+}
+
+static void
+FastXOR(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] ^ m->registers[instr->rt];
+    FinishOp(m);
+}
+
+static void
+FastXORI(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = m->registers[instr->rs] ^ (instr->extra & 0xffff);
+    FinishOp(m);
+}
+
+//----------------------------------------------------------------------
+// FastHandlerFor
+// 	Return the fast handler for an opcode, or NULL if the instruction
+//	must go through ExecuteInstruction.  (SRL and SRLV are left out,
+//	along with OR, to keep their exact interpreter behavior in
+//	one place.)
+//----------------------------------------------------------------------
+
+static FastOpHandler
+FastHandlerFor(int opCode)
+{
+    switch (opCode) {
+      case OP_ADDIU:	return FastADDIU;
+      case OP_ADDU:	return FastADDU;
+      case OP_AND:	return FastAND;
+      case OP_ANDI:	return FastANDI;
+      case OP_LUI:	return FastLUI;
+      case OP_MFHI:	return FastMFHI;
+      case OP_MFLO:	return FastMFLO;
+      case OP_MTHI:	return FastMTHI;
+      case OP_MTLO:	return FastMTLO;
+      case OP_NOR:	return FastNOR;
+      case OP_ORI:	return FastORI;
+      case OP_SLL:	return FastSLL;
+      case OP_SLLV:	return FastSLLV;
+      case OP_SLT:	return FastSLT;
+      case OP_SLTI:	return FastSLTI;
+      case OP_SLTIU:	return FastSLTIU;
+      case OP_SLTU:	return FastSLTU;
+      case OP_SRA:	return FastSRA;
+      case OP_SRAV:	return FastSRAV;
+      case OP_SUBU:	return FastSUBU;
+      case OP_XOR:	return FastXOR;
+      case OP_XORI:	return FastXORI;
+      default:		return NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// Machine::CompileBlock
+// 	Build the basic block starting at physical address "physAddr",
+//	and enter it in the block hash table and the frame's block list.
+//
+//	The block runs up to and including the first instruction that
+//	always traps (syscall, illegal instruction), or the delay slot
+//	of the first branch or jump, or the last instruction in the
+//	frame.  A branch whose delay slot would be in the next frame is
+//	left for a block of its own, since the delay slot would then
+//	run with NextPC pointing at the branch target.
+//
+//	Instructions are decoded through the frame's DecodedPage, which
+//	also makes sure a store into the frame will invalidate the block.
+//----------------------------------------------------------------------
+
+BasicBlock *
+Machine::CompileBlock(int physAddr)
+{
+    int frame = physAddr / PageSize;
+    int end = (frame + 1) * PageSize;
+    int bucket = (physAddr >> 2) & (BlockHashSize - 1);
+    BasicBlock *block = new BasicBlock;
+    DecodedPage *page;
+    bool inDelaySlot = FALSE;
+    int addr, slot, opCode;
+
+    page = decodeCache[frame];
+    if (page == NULL)
+	page = decodeCache[frame] = new DecodedPage;
+
+    block->physAddr = physAddr;
+    block->length = 0;
+    block->valid = TRUE;
+    for (addr = physAddr; addr < end; addr += 4) {
+	slot = (addr % PageSize) / 4;
+	if (!page->valid[slot]) {
+	    stats->numDecodeMisses++;
+	    page->instr[slot].value = 
+			WordToHost(*(unsigned int *) &mainMemory[addr]);
+	    page->instr[slot].Decode();
+	    page->valid[slot] = TRUE;
+	    page->anyValid = TRUE;
+	}
+	opCode = page->instr[slot].opCode;
+	if (!inDelaySlot && (block->length > 0) && (addr + 4 == end)) {
+	    switch (opCode) {		// delay slot would be off the frame
+	      case OP_BEQ: case OP_BGEZ: case OP_BGEZAL: case OP_BGTZ:
+	      case OP_BLEZ: case OP_BLTZ: case OP_BLTZAL: case OP_BNE:
+	      case OP_J: case OP_JAL: case OP_JALR: case OP_JR:
+		addr = end;		// end the block before the branch
+		continue;
+	    }
+	}
+	block->ops[block->length].instr = page->instr[slot];
+	block->ops[block->length].handler = FastHandlerFor(opCode);
+	block->length++;
+	if (inDelaySlot)
+	    break;
+	switch (opCode) {
+	  case OP_BEQ: case OP_BGEZ: case OP_BGEZAL: case OP_BGTZ:
+	  case OP_BLEZ: case OP_BLTZ: case OP_BLTZAL: case OP_BNE:
+	  case OP_J: case OP_JAL: case OP_JALR: case OP_JR:
+	    inDelaySlot = TRUE;
+	    break;
+	  case OP_SYSCALL: case OP_RES: case OP_UNIMP:
+	    addr = end;			// always traps; nothing can follow
+	    break;
+	}
+    }
+    ASSERT(block->length > 0);
+
+    block->hashNext = blockHash[bucket];
+    blockHash[bucket] = block;
+    block->frameNext = frameBlocks[frame];
+    frameBlocks[frame] = block;
+    stats->numBlocksCompiled++;
+    return block;
+}
+
+//----------------------------------------------------------------------
+// Machine::RunBlock
+// 	Run the basic block of user code starting at the current PC, all
+//	at once: simple instructions go straight to their fast handler,
+//	the rest through ExecuteInstruction.  Called only from
+//	RunUntilDue, which charges a tick per instruction without calling
+//	OneTick; we do the same for the whole block at the end, so we
+//	only start a block that will finish before the next interrupt
+//	is due.  If an instruction traps, RaiseException first charges
+//	for the instructions before it (see blockTicks), and the block
+//	ends there; the caller must then call OneTick for the trapping
+//	instruction, just as OneInstruction's caller would.
+//
+//	Returns BlockNotRun, having done nothing, if the block cannot be
+//	run right now -- the PC is in a branch delay slot, the translation
+//	of the PC isn't cached, or "due" is too close -- in which case the
+//	caller steps one instruction the slow way.
+//
+//	"due" -- when the next pending interrupt is due
+//----------------------------------------------------------------------
+
+BlockResult
+Machine::RunBlock(int due)
+{
+    int pc = registers[PCReg];
+    int physAddr, done;
+    char *host;
+    BasicBlock *block;
+    ThreadedOp *op;
+
+    if (deadBlocks != NULL)
+	FreeDeadBlocks();
+    if (registers[NextPCReg] != pc + 4)
+	return BlockNotRun;
+    if ((host = HostLookup(pc, 4, FALSE)) == NULL)
+	return BlockNotRun;
+    physAddr = host - mainMemory;
+    for (block = blockHash[(physAddr >> 2) & (BlockHashSize - 1)];
+		(block != NULL) && (block->physAddr != physAddr);
+		block = block->hashNext)
+	;
+    if (block == NULL)
+	block = CompileBlock(physAddr);
+    if (stats->totalTicks + block->length * UserTick >= due)
+	return BlockNotRun;
+
+    stats->numBlocksRun++;
+    for (done = 0; done < block->length; ) {
+	op = &block->ops[done++];
+	if (op->handler != NULL) {
+	    (*op->handler)(this, &op->instr);
+	    continue;
+	}
+	blockTicks = done - 1;
+	if (!ExecuteInstruction(&op->instr))	// the earlier ones
+	    return BlockTrapped;		// are paid for
+	blockTicks = 0;
+	if (!block->valid)		// the block overwrote itself; stop
+	    break;			// before running stale instructions
+    }
+    stats->totalTicks += done * UserTick;
+    stats->userTicks += done * UserTick;
+    return BlockDone;
+}
 
 //----------------------------------------------------------------------
 // TypeToReg
@@ -67,6 +477,76 @@ TypeToReg(RegType reg, Instruction *instr)
     }
 }
 
+//----------------------------------------------------------------------
+// Machine::FetchHit
+// 	Try to translate "pc" through the host translation cache (see
+//	HostLookup).  Returns FALSE if the caller must use Translate.
+//
+//	"pc" -- the virtual address of the instruction
+//	"physAddr" -- the place to return the physical address
+//----------------------------------------------------------------------
+
+bool
+Machine::FetchHit(int pc, int *physAddr)
+{
+    char *host = HostLookup(pc, 4, FALSE);
+
+    if (host == NULL) {
+	stats->numHostTLBMisses++;
+	return FALSE;
+    }
+    stats->numHostTLBHits++;
+    *physAddr = host - mainMemory;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::FetchInstruction
+// 	Fetch and decode the instruction at virtual address "pc".
+//
+//	Decoded instructions are cached per physical page frame (see
+//	DecodedPage in machine.h), so once an instruction has been seen
+//	we skip both the memory read and Instruction::Decode.  Pages
+//	already in the host translation cache skip Translate as well
+//	(see FetchHit).
+//
+//	Returns NULL if an exception was raised during the fetch.
+//
+//	"pc" -- the virtual address of the instruction
+//----------------------------------------------------------------------
+
+Instruction *
+Machine::FetchInstruction(int pc)
+{
+    DecodedPage *page;
+    int physAddr, slot;
+
+    if (!FetchHit(pc, &physAddr)) {
+	ExceptionType exception = Translate(pc, &physAddr, 4, FALSE);
+	if (exception != NoException) {
+	    RaiseException(exception, pc);
+	    return NULL;
+	}
+	HostFill(pc, physAddr, FALSE);
+    }
+
+    page = decodeCache[physAddr / PageSize];
+    if (page == NULL)
+	page = decodeCache[physAddr / PageSize] = new DecodedPage;
+    slot = (physAddr % PageSize) / 4;
+    if (page->valid[slot]) {
+	stats->numDecodeHits++;
+    } else {
+	stats->numDecodeMisses++;
+	page->instr[slot].value = 
+		WordToHost(*(unsigned int *) &mainMemory[physAddr]);
+	page->instr[slot].Decode();
+	page->valid[slot] = TRUE;
+	page->anyValid = TRUE;
+    }
+    return &page->instr[slot];
+}
+
 //----------------------------------------------------------------------
 // Machine::OneInstruction
 // 	Execute one instruction from a user-level program
@@ -81,28 +561,29 @@ TypeToReg(RegType reg, Instruction *instr)
 //
 //	This routine is re-entrant, in that it can be called multiple
 //	times concurrently -- one for each thread executing user code.
-//	We get re-entrancy by never caching any data -- we always re-start the
+//	We get re-entrancy by never caching any data other than decoded
+//	instructions (which are only ever a function of memory contents,
+//	and are not looked at again once an exception has been raised) -- 
+//	we always re-start the
 //	simulation from scratch each time we are called (or after trapping
 //	back to the Nachos kernel on an exception or interrupt), and we always
 //	store all data back to the machine registers and memory before
 //	leaving.  This allows the Nachos kernel to control our behavior
 //	by controlling the contents of memory, the translation table,
 //	and the register set.
+//
+//	Returns FALSE if an exception was raised.
 //----------------------------------------------------------------------
 
-void
-Machine::OneInstruction(Instruction *instr)
+bool
+Machine::OneInstruction()
 {
-    int raw;
-    int nextLoadReg = 0; 	
-    int nextLoadValue = 0; 	// record delayed load operation, to apply
-				// in the future
+    Instruction *instr;
 
     // Fetch instruction 
-    if (!machine->ReadMem(registers[PCReg], 4, &raw))
-	return;			// exception occurred
-    instr->value = raw;
-    instr->Decode();
+    instr = FetchInstruction(registers[PCReg]);
+    if (instr == NULL)
+	return FALSE;		// exception occurred
 
     if (DebugIsEnabled('m')) {
        struct OpString *str = &opStrings[instr->opCode];
@@ -113,7 +594,29 @@ Machine::OneInstruction(Instruction *instr)
 		TypeToReg(str->args[1], instr), TypeToReg(str->args[2], instr));
        printf("\n");
        }
-    
+
+    return ExecuteInstruction(instr);
+}
+
+//----------------------------------------------------------------------
+// Machine::ExecuteInstruction
+// 	Execute one already decoded instruction, at the current PC.
+//	Shared by OneInstruction and by the basic-block engine (see
+//	RunBlock), for every instruction that has no fast handler.
+//
+//	Returns FALSE if an exception was raised, in which case the
+//	kernel has already been entered and the PC was not advanced.
+//
+//	"instr" -- the decoded instruction at registers[PCReg]
+//----------------------------------------------------------------------
+
+bool
+Machine::ExecuteInstruction(Instruction *instr)
+{
+    int nextLoadReg = 0; 	
+    int nextLoadValue = 0; 	// record delayed load operation, to apply
+				// in the future
+
     // Compute next pc, but don't install in case there's an error or branch.
     int pcAfter = registers[NextPCReg] + 4;
     int sum, diff, tmp, value;
@@ -127,7 +630,7 @@ Machine::OneInstruction(Instruction *instr)
 	if (!((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ sum) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    return FALSE;
 	}
 	registers[instr->rd] = sum;
 	break;
@@ -137,7 +640,7 @@ Machine::OneInstruction(Instruction *instr)
 	if (!((registers[instr->rs] ^ instr->extra) & SIGN_BIT) &&
 	    ((instr->extra ^ sum) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    return FALSE;
 	}
 	registers[instr->rt] = sum;
 	break;
@@ -232,7 +735,7 @@ Machine::OneInstruction(Instruction *instr)
       case OP_LBU:
 	tmp = registers[instr->rs] + instr->extra;
 	if (!machine->ReadMem(tmp, 1, &value))
-	    return;
+	    return FALSE;
 
 	if ((value & 0x80) && (instr->opCode == OP_LB))
 	    value |= 0xffffff00;
@@ -247,10 +750,10 @@ Machine::OneInstruction(Instruction *instr)
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x1) {
 	    RaiseException(AddressErrorException, tmp);
-	    return;
+	    return FALSE;
 	}
 	if (!machine->ReadMem(tmp, 2, &value))
-	    return;
+	    return FALSE;
 
 	if ((value & 0x8000) && (instr->opCode == OP_LH))
 	    value |= 0xffff0000;
@@ -269,10 +772,10 @@ Machine::OneInstruction(Instruction *instr)
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x3) {
 	    RaiseException(AddressErrorException, tmp);
-	    return;
+	    return FALSE;
 	}
 	if (!machine->ReadMem(tmp, 4, &value))
-	    return;
+	    return FALSE;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
 	break;
@@ -286,7 +789,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem(tmp, 4, &value))
-	    return;
+	    return FALSE;
 	if (registers[LoadReg] == instr->rt)
 	    nextLoadValue = registers[LoadValueReg];
 	else
@@ -317,7 +820,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem(tmp, 4, &value))
-	    return;
+	    return FALSE;
 	if (registers[LoadReg] == instr->rt)
 	    nextLoadValue = registers[LoadValueReg];
 	else
@@ -383,13 +886,13 @@ Machine::OneInstruction(Instruction *instr)
       case OP_SB:
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 1, registers[instr->rt]))
-	    return;
+	    return FALSE;
 	break;
 	
       case OP_SH:
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 2, registers[instr->rt]))
-	    return;
+	    return FALSE;
 	break;
 	
       case OP_SLL:
@@ -459,7 +962,7 @@ Machine::OneInstruction(Instruction *instr)
 	if (((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ diff) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    return FALSE;
 	}
 	registers[instr->rd] = diff;
 	break;
@@ -471,7 +974,7 @@ Machine::OneInstruction(Instruction *instr)
       case OP_SW:
 	if (!machine->WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 4, registers[instr->rt]))
-	    return;
+	    return FALSE;
 	break;
 	
       case OP_SWL:	  
@@ -482,7 +985,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem((tmp & ~0x3), 4, &value))
-	    return;
+	    return FALSE;
 	switch (tmp & 0x3) {
 	  case 0:
 	    value = registers[instr->rt];
@@ -501,7 +1004,7 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	if (!machine->WriteMem((tmp & ~0x3), 4, value))
-	    return;
+	    return FALSE;
 	break;
     	
       case OP_SWR:	  
@@ -512,7 +1015,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!machine->ReadMem((tmp & ~0x3), 4, &value))
-	    return;
+	    return FALSE;
 	switch (tmp & 0x3) {
 	  case 0:
 	    value = (value & 0xffffff) | (registers[instr->rt] << 24);
@@ -528,12 +1031,12 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	if (!machine->WriteMem((tmp & ~0x3), 4, value))
-	    return;
+	    return FALSE;
 	break;
     	
       case OP_SYSCALL:
 	RaiseException(SyscallException, 0);
-	return; 
+	return FALSE; 
 	
       case OP_XOR:
 	registers[instr->rd] = registers[instr->rs] ^ registers[instr->rt];
@@ -546,7 +1049,7 @@ Machine::OneInstruction(Instruction *instr)
       case OP_RES:
       case OP_UNIMP:
 	RaiseException(IllegalInstrException, 0);
-	return;
+	return FALSE;
 	
       default:
 	ASSERT(FALSE);
@@ -562,6 +1065,7 @@ Machine::OneInstruction(Instruction *instr)
 						// are jumping into lala-land
     registers[PCReg] = registers[NextPCReg];
     registers[NextPCReg] = pcAfter;
+    return TRUE;
 }
 
 //----------------------------------------------------------------------
@@ -22,6 +22,27 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numPageIns = numPageOuts = 0;
+    lowWatermark = highWatermark = 0;
+    numDaemonWakeups = numDaemonPagesCleaned = numDaemonClusterWrites = 0;
+    numDaemonPagesReclaimed = 0;
+    numCopyOnWriteFaults = numPagesCopied = 0;
+    numTextPagesLoaded = numTextPagesShared = 0;
+    numExecCacheHits = numExecCacheMisses = numExecCacheEvictions = 0;
+    syscalls = new SyscallStats(-1);
+    firstProcess = lastProcess = NULL;
+    for (int i = 0; i < NumSyscallTypes; i++)
+	syscallNames[i] = NULL;
+    syscallDumpFile = NULL;
+    numTimerInterrupts = numContextSwitches = 0;
+    numStacksMade = numStacksReused = numStacksFreed = 0;
+    numHostMemoryCalls = 0;
+    schedPolicy = "fifo";
+    numReadyWaits = readyWaitTicks = longestReadyWait = 0;
+    numPriorityBoosts = numPriorityDrops = numAgingBoosts = 0;
+    numDecodeHits = numDecodeMisses = numDecodeInvalidations = 0;
+    numHostTLBHits = numHostTLBMisses = 0;
+    numBlocksCompiled = numBlocksRun = 0;
 }
 
 //----------------------------------------------------------------------
@@ -38,7 +59,196 @@ Statistics::Print()
     printf("Disk I/O: reads %d, writes %d\n", numDiskReads, numDiskWrites);
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
+    printf("Scheduling: policy %s, timer interrupts %d, context switches "
+	"%d\n", schedPolicy, numTimerInterrupts, numContextSwitches);
+    if (numReadyWaits > 0)
+	printf("Ready list: waits %d, ticks %d, average %d, longest %d\n",
+	    numReadyWaits, readyWaitTicks, readyWaitTicks / numReadyWaits,
+	    longestReadyWait);
+    if (numPriorityBoosts + numPriorityDrops + numAgingBoosts > 0)
+	printf("Priorities: raised on wakeup %d, lowered %d, aging "
+	    "boosts %d\n", numPriorityBoosts, numPriorityDrops,
+	    numAgingBoosts);
+    if (numStacksMade + numStacksReused > 0)
+	printf("Thread stacks: mapped %d, reused %d, unmapped %d, host "
+	    "memory calls %d\n", numStacksMade, numStacksReused,
+	    numStacksFreed, numHostMemoryCalls);
     printf("Paging: faults %d\n", numPageFaults);
+    if (numPageIns + numPageOuts > 0)
+	printf("Swap: page-ins %d, page-outs %d\n", numPageIns, numPageOuts);
+    if (numDaemonWakeups > 0)
+	printf("Pageout daemon: watermarks %d/%d, wakeups %d, pages cleaned "
+	    "%d in %d writes, frames reclaimed %d\n", lowWatermark,
+	    highWatermark, numDaemonWakeups, numDaemonPagesCleaned,
+	    numDaemonClusterWrites, numDaemonPagesReclaimed);
+    if (numCopyOnWriteFaults > 0)
+	printf("Copy-on-write: faults %d, pages copied %d\n",
+	    numCopyOnWriteFaults, numPagesCopied);
+    if (numTextPagesShared > 0)
+	printf("Shared text: pages loaded %d, pages shared %d\n",
+	    numTextPagesLoaded, numTextPagesShared);
+    if (numExecCacheHits + numExecCacheEvictions > 0)
+	printf("Exec cache: hits %d, misses %d, evictions %d\n",
+	    numExecCacheHits, numExecCacheMisses, numExecCacheEvictions);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
+    printf("Decode cache: hits %d, misses %d, invalidations %d\n", 
+	numDecodeHits, numDecodeMisses, numDecodeInvalidations);
+    if (numHostTLBHits + numHostTLBMisses > 0)
+	printf("Host TLB: hits %d, misses %d, hit rate %.1f%%\n",
+	    numHostTLBHits, numHostTLBMisses, 100.0 * numHostTLBHits /
+	    (numHostTLBHits + numHostTLBMisses));
+    if (numBlocksCompiled > 0)
+	printf("Basic blocks: compiled %d, run %d\n", numBlocksCompiled,
+	    numBlocksRun);
+    if (syscalls->Any()) {
+	printf("System calls (latency histogram: ticks 0, <2, <4, <8, ...):\n");
+	syscalls->Print(syscallNames);
+	for (SyscallStats *p = firstProcess; p != NULL; p = p->next)
+	    p->Print(syscallNames);
+    }
+    if (syscallDumpFile != NULL)
+	DumpSyscalls();
+}
+
+//----------------------------------------------------------------------
+// Statistics::NewProcess
+// 	Start keeping system call figures for process "pid".  They are
+//	kept after the process is gone, to be printed at the end.
+//----------------------------------------------------------------------
+
+SyscallStats *
+Statistics::NewProcess(int pid)
+{
+    SyscallStats *p = new SyscallStats(pid);
+
+    if (lastProcess == NULL)
+	firstProcess = p;
+    else
+	lastProcess->next = p;
+    lastProcess = p;
+    return p;
+}
+
+//----------------------------------------------------------------------
+// Statistics::DumpSyscalls
+// 	Write the system call figures to "syscallDumpFile", one line per
+//	process (or "all") and system call, as whitespace separated fields:
+//		who syscall calls ticks bucket0 ... bucket15
+//----------------------------------------------------------------------
+
+void
+Statistics::DumpSyscalls()
+{
+    FILE *file = fopen(syscallDumpFile, "w");
+
+    if (file == NULL) {
+	printf("Unable to write system call figures to %s\n", syscallDumpFile);
+	return;
+    }
+    fprintf(file, "# who syscall calls ticks");
+    for (int b = 0; b < LatencyBuckets; b++)
+	fprintf(file, " b%d", b);
+    fprintf(file, "\n");
+    syscalls->Dump(file, syscallNames);
+    for (SyscallStats *p = firstProcess; p != NULL; p = p->next)
+	p->Dump(file, syscallNames);
+    fclose(file);
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::SyscallStats
+// 	Initialize the figures for process "who" (-1 for all) to zero.
+//----------------------------------------------------------------------
+
+SyscallStats::SyscallStats(int who)
+{
+    pid = who;
+    for (int i = 0; i < NumSyscallTypes; i++) {
+	calls[i] = ticks[i] = 0;
+	for (int b = 0; b < LatencyBuckets; b++)
+	    histogram[i][b] = 0;
+    }
+    next = NULL;
+}
+
+void
+SyscallStats::Entered(int type)
+{
+    ASSERT(type >= 0 && type < NumSyscallTypes);
+    calls[type]++;
+}
+
+void
+SyscallStats::Returned(int type, int elapsed)
+{
+    int bucket = 0;
+
+    ASSERT(type >= 0 && type < NumSyscallTypes && elapsed >= 0);
+    ticks[type] += elapsed;
+    while (elapsed > 0 && bucket < LatencyBuckets - 1) {
+	bucket++;
+	elapsed >>= 1;
+    }
+    histogram[type][bucket]++;
+}
+
+bool
+SyscallStats::Any()
+{
+    for (int i = 0; i < NumSyscallTypes; i++)
+	if (calls[i] > 0)
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::Print
+// 	Print a line for each system call made: how often, the average
+//	latency of the calls that returned, and the histogram up to its
+//	last non-empty bucket.
+//----------------------------------------------------------------------
+
+void
+SyscallStats::Print(char **names)
+{
+    int last, returned;
+
+    for (int i = 0; i < NumSyscallTypes; i++) {
+	if (calls[i] == 0)
+	    continue;
+	returned = 0;
+	for (int b = 0; b < LatencyBuckets; b++)
+	    returned += histogram[i][b];
+	if (pid == -1)
+	    printf("  all");
+	else
+	    printf("  [%d]", pid);
+	printf(" %s: calls %d, ticks %d, avg %d |", names[i] ? names[i] : "?",
+	    calls[i], ticks[i], returned ? ticks[i] / returned : 0);
+	for (last = LatencyBuckets - 1; last > 0 && histogram[i][last] == 0;
+		last--)
+	    ;
+	for (int b = 0; b <= last; b++)
+	    printf(" %d", histogram[i][b]);
+	printf("\n");
+    }
+}
+
+void
+SyscallStats::Dump(FILE *file, char **names)
+{
+    for (int i = 0; i < NumSyscallTypes; i++) {
+	if (calls[i] == 0)
+	    continue;
+	if (pid == -1)
+	    fprintf(file, "all");
+	else
+	    fprintf(file, "%d", pid);
+	fprintf(file, " %s %d %d", names[i] ? names[i] : "?", calls[i],
+	    ticks[i]);
+	for (int b = 0; b < LatencyBuckets; b++)
+	    fprintf(file, " %d", histogram[i][b]);
+	fprintf(file, "\n");
+    }
 }
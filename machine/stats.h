@@ -12,6 +12,36 @@
 #define STATS_H
 
 #include "copyright.h"
+#include "utility.h"
+
+#define NumSyscallTypes	16	// system call codes we keep figures for
+#define LatencyBuckets	16	// histogram buckets, by log2 of ticks
+
+// Counts and latencies of the system calls made by one process, or by
+// all of them.  The latency of a call, in simulated ticks from entry
+// to return, goes in bucket 0 if it took no time, or else in bucket
+// 1 + floor(log2(ticks)), with the last bucket taking everything
+// longer.  Calls that never return (Exit, Halt) are counted, but have
+// no latency.
+
+class SyscallStats {
+  public:
+    SyscallStats(int who);		// -1 for the totals
+
+    void Entered(int type);		// a call was made
+    void Returned(int type, int elapsed);	// and returned "elapsed"
+					// ticks later
+    bool Any();				// were any calls made?
+
+    void Print(char **names);		// one line per syscall used
+    void Dump(FILE *file, char **names);// machine-readable lines
+
+    int pid;				// whose calls, or -1
+    int calls[NumSyscallTypes];		// times each was called
+    int ticks[NumSyscallTypes];		// total latency of each
+    int histogram[NumSyscallTypes][LatencyBuckets];
+    SyscallStats *next;			// next process, in the list
+};
 
 // The following class defines the statistics that are to be kept
 // about Nachos behavior -- how much time (ticks) elapsed, how
@@ -33,12 +63,57 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numPageIns;		// pages read back from swap
+    int numPageOuts;		// pages written out to swap
+    int lowWatermark;		// free frames below which the pageout
+    int highWatermark;		// daemon wakes, and up to which it frees
+    int numDaemonWakeups;	// times the pageout daemon ran
+    int numDaemonPagesCleaned;	// dirty pages it wrote out ahead of time
+    int numDaemonClusterWrites;	// in this many disk writes
+    int numDaemonPagesReclaimed; // frames it freed
+    int numCopyOnWriteFaults;	// writes to pages shared since a Fork
+    int numPagesCopied;		// and how many of those copied a frame
+    int numTextPagesLoaded;	// code pages read in, and code pages
+    int numTextPagesShared;	// mapped from another run of the program
+    int numExecCacheHits;	// programs whose image was cached idle,
+    int numExecCacheMisses;	// or had to be read in
+    int numExecCacheEvictions;	// idle images thrown out of the cache
+    int numTimerInterrupts;	// time slices that ran out
+    int numContextSwitches;	// times Scheduler::Run switched threads
+    int numStacksMade;		// thread stacks mapped from the host,
+    int numStacksReused;	// taken from the StackPool instead,
+    int numStacksFreed;		// and given back to the host
+    int numHostMemoryCalls;	// mmap, mprotect and munmap calls made
+    char *schedPolicy;		// name of the scheduling policy
+    int numReadyWaits;		// times a thread waited on the ready
+    int readyWaitTicks;		// list, and for how long in all
+    int longestReadyWait;
+    int numPriorityBoosts;	// MLFQ: levels gained on wakeup,
+    int numPriorityDrops;	// and lost by using up a quantum
+    int numAgingBoosts;		// times everyone went back to the top
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
+    int numDecodeHits;		// instruction fetches served by the
+				// decoded instruction cache
+    int numDecodeMisses;	// instruction fetches that had to decode
+    int numDecodeInvalidations; // frames whose decoded code was discarded
+    int numHostTLBHits;		// memory references that did, and did not,
+    int numHostTLBMisses;	// skip Translate (see HostTLBEntry)
+    int numBlocksCompiled;	// basic blocks built by the threaded-code
+    int numBlocksRun;		// engine, and times one was run
+
+    SyscallStats *syscalls;	// system calls made by all processes,
+    SyscallStats *firstProcess;	// and by each, oldest first
+    SyscallStats *lastProcess;
+    char *syscallNames[NumSyscallTypes];	// for printing
+    char *syscallDumpFile;	// where to dump the figures at Halt,
+				// or NULL
 
     Statistics(); 		// initialize everything to zero
 
+    SyscallStats *NewProcess(int pid);	// figures for process "pid"
     void Print();		// print collected statistics
+    void DumpSyscalls();	// write syscall figures to syscallDumpFile
 };
 
 // Constants used to reflect the relative time an operation would
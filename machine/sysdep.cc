@@ -36,6 +36,7 @@ extern "C" {
 #include <sys/file.h>
 #include <sys/un.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #ifdef HOST_i386
 #include <unistd.h>
 #include <sys/time.h>
@@ -243,6 +244,23 @@ Tell(int fd)
 }
 
 
+//----------------------------------------------------------------------
+// FileId
+// 	Identify the file open on "fd" by the device it is on and its
+//	i-node number there: the same for every descriptor open on that
+//	file.  I-node numbers are only unique within a device.
+//----------------------------------------------------------------------
+
+void 
+FileId(int fd, int *device, int *inode)
+{
+    struct stat buf;
+    int retVal = fstat(fd, &buf);
+    ASSERT(retVal >= 0);
+    *device = (int) buf.st_dev;
+    *inode = (int) buf.st_ino;
+}
+
 //----------------------------------------------------------------------
 // Close
 // 	Close a file.  Abort on error.
@@ -470,6 +488,11 @@ Random()
 //	the end of the array.  Particularly useful for catching overflow
 //	beyond fixed-size thread execution stacks.
 //
+//	The array is mapped afresh, so that the guard pages can be
+//	protected: one mmap and two mprotects, counted in
+//	stats->numHostMemoryCalls.  Thread stacks come through the
+//	StackPool (stackpool.h), which recycles them to save the calls.
+//
 //	Note: Just return the useful part!
 //
 //	"size" -- amount of useful space needed (in bytes)
@@ -479,16 +502,20 @@ char *
 AllocBoundedArray(int size)
 {
     int pgSize = getpagesize();
-    char *ptr = new char[pgSize * 2 + size];
-
-    //mprotect(ptr, pgSize, 0);
-    //mprotect(ptr + pgSize + size, pgSize, 0);
+    int rounded = (size + pgSize - 1) / pgSize * pgSize;
+    char *ptr = (char *) mmap(NULL, pgSize * 2 + rounded,
+			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+
+    ASSERT(ptr != (char *) MAP_FAILED);
+    mprotect(ptr, pgSize, PROT_NONE);
+    mprotect(ptr + pgSize + rounded, pgSize, PROT_NONE);
+    stats->numHostMemoryCalls += 3;
     return ptr + pgSize;
 }
 
 //----------------------------------------------------------------------
 // DeallocBoundedArray
-// 	Deallocate an array of integers, unprotecting its two boundary pages.
+// 	Deallocate an array of integers, along with its two boundary pages.
 //
 //	"ptr" -- the array to be deallocated
 //	"size" -- amount of useful space in the array (in bytes)
@@ -498,8 +525,8 @@ void
 DeallocBoundedArray(char *ptr, int size)
 {
     int pgSize = getpagesize();
+    int rounded = (size + pgSize - 1) / pgSize * pgSize;
 
-    mprotect(ptr - pgSize, pgSize, PROT_READ | PROT_WRITE | PROT_EXEC);
-    mprotect(ptr + size, pgSize, PROT_READ | PROT_WRITE | PROT_EXEC);
-    delete [] (ptr - pgSize);
+    munmap(ptr - pgSize, pgSize * 2 + rounded);
+    stats->numHostMemoryCalls++;
 }
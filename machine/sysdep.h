@@ -26,6 +26,7 @@ extern int ReadPartial(int fd, char *buffer, int nBytes);
 extern void WriteFile(int fd, char *buffer, int nBytes);
 extern void Lseek(int fd, int offset, int whence);
 extern int Tell(int fd);
+extern void FileId(int fd, int *device, int *inode);
 extern void Close(int fd);
 extern bool Unlink(char *name);
 
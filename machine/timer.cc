@@ -46,27 +46,59 @@ Timer::Timer(VoidFunctionPtr timerHandler, int callArg, bool doRandom)
     randomize = doRandom;
     handler = timerHandler;
     arg = callArg; 
+    disabled = FALSE;
 
     // schedule the first interrupt from the timer device
-    interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
-		TimerInt); 
+    pending = interrupt->Schedule(TimerHandler, (int) this, 
+		TimeOfNextInterrupt(), TimerInt); 
 }
 
 //----------------------------------------------------------------------
 // Timer::TimerExpired
 //      Routine to simulate the interrupt generated by the hardware 
-//	timer device.  Schedule the next interrupt, and invoke the
-//	interrupt handler.
+//	timer device.  Invoke the interrupt handler, and schedule the
+//	next interrupt, unless the handler has disabled the timer.
 //----------------------------------------------------------------------
 void 
 Timer::TimerExpired() 
 {
-    // schedule the next timer device interrupt
-    interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
-		TimerInt);
+    pending = NULL;
 
     // invoke the Nachos interrupt handler for this device
     (*handler)(arg);
+
+    // schedule the next timer device interrupt
+    if (!disabled)
+	pending = interrupt->Schedule(TimerHandler, (int) this, 
+		TimeOfNextInterrupt(), TimerInt);
+}
+
+//----------------------------------------------------------------------
+// Timer::Disable
+// Timer::Enable
+//      Stop and restart the timer.  A stopped timer has no interrupt
+//	outstanding, so while nothing needs it, it neither interrupts
+//	anyone nor keeps an idle machine from skipping ahead to the next
+//	real device interrupt.
+//----------------------------------------------------------------------
+
+void
+Timer::Disable()
+{
+    disabled = TRUE;
+    if (pending != NULL) {
+	interrupt->Cancel(pending);
+	pending = NULL;
+    }
+}
+
+void
+Timer::Enable()
+{
+    disabled = FALSE;
+    if (pending == NULL)
+	pending = interrupt->Schedule(TimerHandler, (int) this, 
+		TimeOfNextInterrupt(), TimerInt);
 }
 
 //----------------------------------------------------------------------
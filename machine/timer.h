@@ -23,6 +23,8 @@
 #include "copyright.h"
 #include "utility.h"
 
+class PendingInterrupt;
+
 // The following class defines a hardware timer. 
 class Timer {
   public:
@@ -31,6 +33,11 @@ class Timer {
 				// handler "timerHandler" every time slice.
     ~Timer() {}
 
+    void Disable();		// stop interrupting
+    void Enable();		// start interrupting again, a full
+				// interval from now
+    bool IsEnabled() { return !disabled; }
+
 // Internal routines to the timer emulation -- DO NOT call these
 
     void TimerExpired();	// called internally when the hardware
@@ -43,6 +50,8 @@ class Timer {
     bool randomize;		// set if we need to use a random timeout delay
     VoidFunctionPtr handler;	// timer interrupt handler 
     int arg;			// argument to pass to interrupt handler
+    bool disabled;		// set by Disable
+    PendingInterrupt *pending;	// the next interrupt, or NULL
 
 };
 
@@ -93,10 +93,18 @@ Machine::ReadMem(int addr, int size, int *value)
     
     DEBUG('a', "Reading VA 0x%x, size %d\n", addr, size);
     
-    exception = Translate(addr, &physicalAddress, size, FALSE);
-    if (exception != NoException) {
-	machine->RaiseException(exception, addr);
-	return FALSE;
+    char *host = HostLookup(addr, size, FALSE);
+    if (host != NULL) {
+	stats->numHostTLBHits++;
+	physicalAddress = host - mainMemory;
+    } else {
+	stats->numHostTLBMisses++;
+	exception = Translate(addr, &physicalAddress, size, FALSE);
+	if (exception != NoException) {
+	    machine->RaiseException(exception, addr);
+	    return FALSE;
+	}
+	HostFill(addr, physicalAddress, FALSE);
     }
     switch (size) {
       case 1:
@@ -142,11 +150,22 @@ Machine::WriteMem(int addr, int size, int value)
      
     DEBUG('a', "Writing VA 0x%x, size %d, value 0x%x\n", addr, size, value);
 
-    exception = Translate(addr, &physicalAddress, size, TRUE);
-    if (exception != NoException) {
-	machine->RaiseException(exception, addr);
-	return FALSE;
+    char *host = HostLookup(addr, size, TRUE);
+    if (host != NULL) {
+	stats->numHostTLBHits++;
+	physicalAddress = host - mainMemory;
+    } else {
+	stats->numHostTLBMisses++;
+	exception = Translate(addr, &physicalAddress, size, TRUE);
+	if (exception != NoException) {
+	    machine->RaiseException(exception, addr);
+	    return FALSE;
+	}
+	HostFill(addr, physicalAddress, TRUE);
     }
+    if ((decodeCache[physicalAddress / PageSize] != NULL)
+	    && decodeCache[physicalAddress / PageSize]->anyValid)
+	InvalidateFrame(physicalAddress / PageSize);	// code was modified
     switch (size) {
       case 1:
 	machine->mainMemory[physicalAddress] = (unsigned char) (value & 0xff);
@@ -168,6 +187,35 @@ Machine::WriteMem(int addr, int size, int value)
     return TRUE;
 }
 
+//----------------------------------------------------------------------
+// Machine::HostFill
+// 	Remember a translation that Translate has just completed, so that
+//	later references to the same page can skip it (see HostLookup).
+//	A page becomes writable in the cache only through a write, which
+//	is when Translate has checked readOnly and set the dirty bit;
+//	reading a page already cached as writable keeps it writable.
+//
+//	"virtAddr" -- the virtual address that was translated
+//	"physAddr" -- the physical address Translate returned
+//	"writing" -- was the translation for a write?
+//----------------------------------------------------------------------
+
+void
+Machine::HostFill(int virtAddr, int physAddr, bool writing)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    HostTLBEntry *e = &hostTLB[vpn & (HostTLBSize - 1)];
+
+    if (!useHostTLB)
+	return;
+    if ((e->page == NULL) || (e->vpn != vpn))
+	e->writable = FALSE;
+    e->vpn = vpn;
+    e->page = &mainMemory[(physAddr / PageSize) * PageSize];
+    if (writing)
+	e->writable = TRUE;
+}
+
 //----------------------------------------------------------------------
 // Machine::Translate
 // 	Translate a virtual address into a physical address, using 
@@ -241,15 +289,15 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 
     // if the pageFrame is too big, there is something really wrong! 
     // An invalid translation was loaded into the page table or TLB. 
-    if (pageFrame >= NumPhysPages) { 
-	DEBUG('a', "*** frame %d > %d!\n", pageFrame, NumPhysPages);
+    if (pageFrame >= (unsigned) numPhysPages) { 
+	DEBUG('a', "*** frame %d > %d!\n", pageFrame, numPhysPages);
 	return BusErrorException;
     }
     entry->use = TRUE;		// set the use, dirty bits
     if (writing)
 	entry->dirty = TRUE;
     *physAddr = pageFrame * PageSize + offset;
-    ASSERT((*physAddr >= 0) && ((*physAddr + size) <= MemorySize));
+    ASSERT((*physAddr >= 0) && ((*physAddr + size) <= memorySize));
     DEBUG('a', "phys addr = 0x%x\n", *physAddr);
     return NoException;
 }
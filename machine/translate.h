@@ -41,6 +41,9 @@ class TranslationEntry {
     bool dirty;         // This bit is set by the hardware every time the
 			// page is modified.
     bool inMemory;      //indicates whether the page currently exists in memory
+    bool copyOnWrite;	// If this bit is set, "readOnly" is only there
+			// because the frame is shared since a Fork: the 
+			// first write copies the page (see copyOnWriteFault)
 };
 
 #endif
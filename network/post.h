@@ -68,6 +68,7 @@ class Mail {
      PacketHeader pktHdr;	// Header appended by Network
      MailHeader mailHdr;	// Header appended by PostOffice
      char data[MaxMailSize];	// Payload -- message data
+     ListLink link;		// for the mailbox's list of messages
 };
 
 // The following class defines a single mailbox, or temporary storage
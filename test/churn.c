@@ -0,0 +1,35 @@
+/* churn.c 
+ *	Stress the physical frame allocator with fork/exit churn: every
+ *	round forks a handful of children, which exit at once, and reaps
+ *	them, so each round allocates and frees several address spaces'
+ *	worth of frames.
+ *
+ *	Needs room for WIDTH + 1 address spaces, e.g.
+ *		nachos -mem 256 -x ../test/churn
+ */
+
+#include "syscall.h"
+
+#define ROUNDS	500	/* rounds of fork and join */
+#define WIDTH	4	/* children alive at once */
+
+void
+child()
+{
+    Exit(0);
+}
+
+int
+main()
+{
+    int round, i, pids[WIDTH];
+
+    for (round = 0; round < ROUNDS; round++) {
+	for (i = 0; i < WIDTH; i++)
+	    pids[i] = Fork(child);
+	for (i = 0; i < WIDTH; i++)
+	    if (pids[i] > 0)
+		Join(pids[i]);
+    }
+    Exit(0);
+}
@@ -0,0 +1,37 @@
+/* shares.c 
+ *	Fork three children that compute for the same length of time,
+ *	holding 100, 200 and 400 tickets.  Under the stride scheduler
+ *	they should get the CPU in the ratio 1:2:4 while all three are
+ *	running; the report at Halt gives the shares they got.
+ *
+ *		nachos -sp stride -mem 128 -x ../test/shares
+ */
+
+#include "syscall.h"
+
+#define WORK	20000	/* loop iterations per child */
+
+int tickets;		/* for the next child; each gets a copy */
+
+void
+child()
+{
+    int i, sum = 0;
+
+    SetTickets(tickets);
+    for (i = 0; i < WORK; i++)
+	sum += i;
+    Exit(sum == WORK * (WORK - 1) / 2);
+}
+
+int
+main()
+{
+    int id, ok = 0;
+
+    for (tickets = 100; tickets <= 400; tickets *= 2)
+	Fork(child);
+    while ((id = JoinAny()) != -1)
+	ok += Join(id);
+    Halt();
+}
@@ -138,6 +138,30 @@ Kill:
         j       $31
         .end Kill
 
+        .globl JoinAny
+        .ent JoinAny
+JoinAny:
+        addiu $2,$0,SC_JoinAny
+        syscall
+        j       $31
+        .end JoinAny
+
+        .globl Sleep
+        .ent Sleep
+Sleep:
+        addiu $2,$0,SC_Sleep
+        syscall
+        j       $31
+        .end Sleep
+
+        .globl SetTickets
+        .ent SetTickets
+SetTickets:
+        addiu $2,$0,SC_SetTickets
+        syscall
+        j       $31
+        .end SetTickets
+
 /* dummy function to keep gcc happy */
         .globl  __main
         .ent    __main
@@ -0,0 +1,36 @@
+/* waitall.c 
+ *	Fork a batch of children that compute for a while, and collect
+ *	them in whatever order they finish with JoinAny.  The parent
+ *	sleeps until a child exits, so compare the context switches with
+ *	a version that polls Join in a Yield loop.
+ *
+ *	Needs room for WIDTH + 1 address spaces, e.g.
+ *		nachos -mem 256 -x ../test/waitall
+ */
+
+#include "syscall.h"
+
+#define WIDTH	8	/* children alive at once */
+#define WORK	5000	/* loop iterations per child */
+
+void
+child()
+{
+    int i, sum = 0;
+
+    for (i = 0; i < WORK; i++)
+	sum += i;
+    Exit(sum == WORK * (WORK - 1) / 2);
+}
+
+int
+main()
+{
+    int i, id, ok = 0;
+
+    for (i = 0; i < WIDTH; i++)
+	Fork(child);
+    while ((id = JoinAny()) != -1)
+	ok += Join(id);
+    Exit(ok);
+}
@@ -0,0 +1,181 @@
+// alarm.cc 
+//	Routines to let threads sleep for a while, woken up by an
+//	interrupt scheduled for the earliest of them.  See alarm.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "alarm.h"
+#include "system.h"
+
+// dummy function because C++ does not allow pointers to member functions
+static void AlarmHandler(int arg)
+{ Alarm *p = (Alarm *)arg; p->CallBack(); }
+
+//----------------------------------------------------------------------
+// Alarm::Alarm
+// 	Initialize an alarm clock with nobody asleep, and so no interrupt
+//	outstanding.
+//----------------------------------------------------------------------
+
+Alarm::Alarm()
+{
+    capacity = 16;
+    heap = new Sleeper[capacity];
+    size = 0;
+    nextSeq = 0;
+    wakeup = NULL;
+}
+
+Alarm::~Alarm()
+{
+    delete [] heap;
+}
+
+//----------------------------------------------------------------------
+// Alarm::Arm
+// 	Make sure the one interrupt we keep outstanding is due when the
+//	earliest sleeper is, or that there is none if nobody sleeps.
+//	Called with interrupts off, whenever heap[0] may have changed.
+//----------------------------------------------------------------------
+
+void
+Alarm::Arm()
+{
+    int fromNow;
+
+    if (wakeup != NULL && (size == 0 || wakeup->when != heap[0].when)) {
+	interrupt->Cancel(wakeup);
+	wakeup = NULL;
+    }
+    if (wakeup == NULL && size > 0) {
+	fromNow = heap[0].when - stats->totalTicks;
+	if (fromNow < 1)
+	    fromNow = 1;
+	wakeup = interrupt->Schedule(AlarmHandler, (int) this, fromNow,
+			AlarmInt);
+    }
+}
+
+//----------------------------------------------------------------------
+// Alarm::Pause
+// 	Put the current thread to sleep until at least "howLong" ticks
+//	from now, or until Wake.  The thread goes into the heap, sifted up
+//	from the bottom; if it is now the first due, the interrupt is
+//	moved up.
+//----------------------------------------------------------------------
+
+void
+Alarm::Pause(int howLong)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    Sleeper me;
+    int i, parent;
+
+    if (howLong <= 0) {
+	(void) interrupt->SetLevel(oldLevel);
+	return;
+    }
+    if (size == capacity) {		// out of room, double the heap
+	Sleeper *bigger = new Sleeper[2 * capacity];
+
+	for (i = 0; i < size; i++)
+	    bigger[i] = heap[i];
+	delete [] heap;
+	heap = bigger;
+	capacity *= 2;
+    }
+    me.thread = currentThread;
+    me.when = stats->totalTicks + howLong;
+    me.seq = nextSeq++;
+    for (i = size++; i > 0; i = parent) {
+	parent = (i - 1) / 2;
+	if (!Earlier(&me, &heap[parent]))
+	    break;
+	heap[i] = heap[parent];
+    }
+    heap[i] = me;
+
+    DEBUG('t', "Thread \"%s\" sleeping until %d\n", currentThread->getName(),
+	  me.when);
+    if (i == 0)
+	Arm();
+    currentThread->Sleep();
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Alarm::Remove
+// 	Take heap[i] off the heap: the last element takes its place, and
+//	is sifted up or down to where it belongs.
+//----------------------------------------------------------------------
+
+void
+Alarm::Remove(int i)
+{
+    Sleeper last = heap[--size];
+    int child, parent;
+
+    if (i == size)
+	return;
+    for (; i > 0; i = parent) {
+	parent = (i - 1) / 2;
+	if (!Earlier(&last, &heap[parent]))
+	    break;
+	heap[i] = heap[parent];
+    }
+    for (; (child = 2 * i + 1) < size; i = child) {
+	if ((child + 1 < size) && Earlier(&heap[child + 1], &heap[child]))
+	    child++;
+	if (!Earlier(&heap[child], &last))
+	    break;
+	heap[i] = heap[child];
+    }
+    heap[i] = last;
+}
+
+//----------------------------------------------------------------------
+// Alarm::Wake
+// 	If thread "t" is asleep here, wake it up now, before its time,
+//	and return TRUE.  A linear search, but only Kill needs it.
+//----------------------------------------------------------------------
+
+bool
+Alarm::Wake(Thread *t)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    int i;
+
+    for (i = 0; i < size; i++)
+	if (heap[i].thread == t) {
+	    Remove(i);
+	    Arm();
+	    scheduler->ReadyToRun(t);
+	    (void) interrupt->SetLevel(oldLevel);
+	    return TRUE;
+	}
+    (void) interrupt->SetLevel(oldLevel);
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// Alarm::CallBack
+// 	Called, with interrupts off, when the alarm interrupt goes off.
+//	Wake up every thread whose time has come, earliest first, and
+//	schedule the interrupt for the next one, if anyone is left.
+//----------------------------------------------------------------------
+
+void
+Alarm::CallBack()
+{
+    wakeup = NULL;			// it has just fired
+    while (size > 0 && heap[0].when <= stats->totalTicks) {
+	DEBUG('t', "Waking thread \"%s\", due at %d\n",
+	      heap[0].thread->getName(), heap[0].when);
+	scheduler->ReadyToRun(heap[0].thread);
+	Remove(0);
+    }
+    Arm();
+}
@@ -0,0 +1,69 @@
+// alarm.h 
+//	Data structures for an alarm clock, which lets a thread sleep
+//	for a given amount of simulated time.
+//
+//	Sleeping threads wait in a binary min-heap ordered by wakeup
+//	time.  Rather than checking the heap on every tick of a periodic
+//	timer, the alarm keeps exactly one interrupt outstanding, due
+//	when the earliest sleeper is, and its handler puts back on the
+//	ready list every thread whose time has come.  So sleepers wake
+//	on time, threads due together are woken by one interrupt, and
+//	while nobody sleeps the alarm costs nothing: an idle machine
+//	skips straight ahead to the next wakeup, or halts if there is
+//	none.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "thread.h"
+
+class PendingInterrupt;
+
+// A thread waiting for the alarm to wake it up.
+
+struct Sleeper {
+    Thread *thread;		// who is asleep
+    int when;			// when to wake up, in stats->totalTicks
+    unsigned int seq;		// order of going to sleep, so that threads
+				// due at the same time wake first-come,
+				// first-served
+};
+
+// The following class defines the alarm clock.
+
+class Alarm {
+  public:
+    Alarm();			// initialize an alarm with nobody asleep
+    ~Alarm();
+
+    void Pause(int howLong);	// put the current thread to sleep for
+				// at least "howLong" ticks (unless
+				// woken early by Wake)
+    bool Wake(Thread *t);	// wake "t" up early, if it is
+				// asleep here; for Kill
+    void CallBack();		// called from the alarm interrupt
+				// handler: wake up whoever is due
+    int NumSleeping() { return size; }
+
+  private:
+    Sleeper *heap;		// heap[0] is the next to wake up
+    int size;			// number of sleeping threads
+    int capacity;		// number of slots in "heap"
+    unsigned int nextSeq;	// "seq" for the next sleeper
+    PendingInterrupt *wakeup;	// the interrupt for heap[0], or NULL
+
+    void Remove(int i);		// take heap[i] off the heap
+    void Arm();			// make "wakeup" match heap[0]
+    bool Earlier(Sleeper *a, Sleeper *b) {
+	return (a->when < b->when) || 
+		((a->when == b->when) && ((int) (a->seq - b->seq) < 0));
+    }
+};
+
+#endif // ALARM_H
@@ -246,3 +246,122 @@ List:: Top()
     return first->item;
 }
 //end of External code
+
+//----------------------------------------------------------------------
+// ListLink::Unlink
+//	Take the item this link belongs to off whatever list it is on.
+//	For an item that is going away.
+//----------------------------------------------------------------------
+
+void
+ListLink::Unlink()
+{
+    if (list != NULL)
+	(void) list->Remove(this);
+}
+
+//----------------------------------------------------------------------
+// LinkList::LinkList
+//	Initialize an intrusive list, empty to start with.
+//----------------------------------------------------------------------
+
+LinkList::LinkList()
+{
+    first = last = NULL;
+    length = 0;
+}
+
+//----------------------------------------------------------------------
+// LinkList::Append
+// LinkList::Prepend
+//	Put "item" at the end (or the front) of the list, through "link",
+//	which is part of it and must not be on any list.  Nothing is
+//	allocated.
+//----------------------------------------------------------------------
+
+void
+LinkList::Append(ListLink *link, void *item)
+{
+    ASSERT(link->list == NULL);
+    link->list = this;
+    link->item = item;
+    link->next = NULL;
+    link->prev = last;
+    if (last != NULL)
+	last->next = link;
+    else
+	first = link;
+    last = link;
+    length++;
+}
+
+void
+LinkList::Prepend(ListLink *link, void *item)
+{
+    ASSERT(link->list == NULL);
+    link->list = this;
+    link->item = item;
+    link->prev = NULL;
+    link->next = first;
+    if (first != NULL)
+	first->prev = link;
+    else
+	last = link;
+    first = link;
+    length++;
+}
+
+//----------------------------------------------------------------------
+// LinkList::RemoveFirst
+//	Take the first item off the list and return it, or NULL if the
+//	list is empty.
+//----------------------------------------------------------------------
+
+void *
+LinkList::RemoveFirst()
+{
+    ListLink *link = first;
+
+    if (link == NULL)
+	return NULL;
+    (void) Remove(link);
+    return link->item;
+}
+
+//----------------------------------------------------------------------
+// LinkList::Remove
+//	Unlink "link" from wherever it is in the list.  Returns FALSE,
+//	and does nothing, if it isn't on this list.
+//----------------------------------------------------------------------
+
+bool
+LinkList::Remove(ListLink *link)
+{
+    if (link->list != this)
+	return FALSE;
+    if (link->prev != NULL)
+	link->prev->next = link->next;
+    else
+	first = link->next;
+    if (link->next != NULL)
+	link->next->prev = link->prev;
+    else
+	last = link->prev;
+    link->next = link->prev = NULL;
+    link->list = NULL;
+    length--;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// LinkList::Mapcar
+//	Apply "func" to every item on the list, first to last.  "func"
+//	must not take the item off the list.
+//----------------------------------------------------------------------
+
+void
+LinkList::Mapcar(VoidFunctionPtr func)
+{
+    for (ListLink *link = first; link != NULL; link = link->next)
+	(*func)((int) link->item);
+}
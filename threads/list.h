@@ -6,6 +6,9 @@
 //	pending interrupts, etc.  That is why each item is a "void *",
 //	or in other words, a "pointers to anything".
 //
+//	Also, intrusive lists, which keep their links in the items
+//	themselves, for queues that must not allocate memory.
+//
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
@@ -65,4 +68,68 @@ class List {
     ListElement *last;		// Last element of list
 };
 
+// The following classes define an "intrusive" list.  A List allocates
+// a ListElement for every item put on it, and deletes it when the item
+// comes off; that is too slow for the kernel's queues of threads and
+// messages, which items join and leave all the time.  Instead, each
+// item that can go on an intrusive list has a ListLink of its own,
+// and the list is linked through those: so putting an item on, and
+// taking it off (from either end, or from the middle) allocate
+// nothing and take constant time.  The catch is that an item can be
+// on only one list at a time per ListLink it has.
+//
+// LinkList does the work, on the links; IntrusiveList<T, Link> is the
+// front end for a list of T's, linked through their member "Link".
+//
+// As with List, mutual exclusion must be provided by the caller.
+
+class LinkList;
+
+class ListLink {
+  public:
+    ListLink() { next = prev = NULL; list = NULL; item = NULL; }
+    bool IsLinked() { return (list != NULL); }
+    void Unlink();		// take it off its list, if it is on one
+
+  private:
+    ListLink *next;		// neighbours on the list, NULL at the ends
+    ListLink *prev;
+    LinkList *list;		// the list it is on, NULL if none
+    void *item;			// the object it belongs to
+    friend class LinkList;
+};
+
+class LinkList {
+  public:
+    LinkList();			// initialize the list, empty
+    ~LinkList() {}		// the items aren't ours
+
+    void Append(ListLink *link, void *item);	// put "item" at the end,
+    void Prepend(ListLink *link, void *item);	// or the front, through
+						// its "link"
+    void *RemoveFirst();	// take the front item off, NULL if none
+    bool Remove(ListLink *link);	// take "link" off; FALSE if it
+					// isn't on this list
+    void *Top() { return (first != NULL) ? first->item : NULL; }
+    bool IsEmpty() { return (first == NULL); }
+    int Length() { return length; }
+    void Mapcar(VoidFunctionPtr func);	// apply "func" to every item,
+					// front to back
+
+  private:
+    ListLink *first;		// NULL if the list is empty
+    ListLink *last;
+    int length;
+};
+
+template <class T, ListLink T::*Link>
+class IntrusiveList : public LinkList {
+  public:
+    void Append(T *item) { LinkList::Append(&(item->*Link), item); }
+    void Prepend(T *item) { LinkList::Prepend(&(item->*Link), item); }
+    T *Remove() { return (T *) RemoveFirst(); }
+    bool Remove(T *item) { return LinkList::Remove(&(item->*Link)); }
+    T *Top() { return (T *) LinkList::Top(); }
+};
+
 #endif // LIST_H
@@ -8,8 +8,12 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
-//		-s -x <nachos file> -c <consoleIn> <consoleOut>
+// Usage: nachos -d <debugflags> -rs <random seed #> -sp <fifo|mlfq|stride>
+//		-sc <stacks> -sw <stacks> -q <test #>
+//		-s -bb -mem <frames> -ec <pages> -sd <unix file>
+//		-x <nachos file>
+//		-rp <fifo|clock|eclock> -swap <pages> -wm <low> <high>
+//		-c <consoleIn> <consoleOut>
 //		-f -cp <unix file> <nachos file>
 //		-p <nachos file> -r <nachos file> -l -D -t
 //              -n <network reliability> -m <machine id>
@@ -18,13 +22,28 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -sp picks the scheduling policy (default fifo)
+//    -sc sets how many idle thread stacks are kept for reuse (default 16)
+//    -sw makes that many idle stacks at boot (default none)
+//    -q picks the thread test to run, in any position (default 1)
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
+//    -bb runs user programs a basic block at a time (threaded code)
+//    -mem sets the number of physical page frames (default 32)
+//    -ec sets how many pages programs that have exited may keep
+//	cached, for the next Exec of the same file (default 16)
+//    -sd writes the system call counts and latency histograms to a
+//	UNIX file, in a machine-readable form, when Nachos halts
 //    -x runs a user program
 //    -c tests the console
 //
+//  VM
+//    -rp picks the page replacement policy (default clock)
+//    -swap sets the size of the swap file, in pages (default 1024)
+//    -wm sets the free frame watermarks of the pageout daemon
+//
 //  FILESYS
 //    -f causes the physical disk to be formatted
 //    -cp copies a file from UNIX to Nachos
@@ -90,14 +109,9 @@ main(int argc, char **argv)
 #ifdef THREADS
     for (argc--, argv++; argc > 0; argc -= argCount, argv += argCount) {
       argCount = 1;
-      switch (argv[0][1]) {
-      case 'q':
-        testnum = atoi(argv[1]);
-        argCount++;
-        break;
-      default:
-        testnum = 1;
-        break;
+      if (!strcmp(*argv, "-q")) {	// which test; other flags leave
+        testnum = atoi(argv[1]);	// it alone, so they can come
+        argCount++;			// before or after it
       }
     }
 
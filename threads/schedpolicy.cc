@@ -0,0 +1,492 @@
+// schedpolicy.cc 
+//	Scheduling policies: see schedpolicy.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "schedpolicy.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// NewSchedPolicy
+// 	Make the policy called "name" ("fifo", "mlfq" or "stride"), as
+//	given with -sp.  Returns NULL for an unknown name.
+//----------------------------------------------------------------------
+
+SchedPolicy *
+NewSchedPolicy(char *name)
+{
+    if (!strcmp(name, "fifo"))
+	return new FIFOSchedPolicy;
+    if (!strcmp(name, "mlfq"))
+	return new MLFQSchedPolicy;
+    if (!strcmp(name, "stride"))
+	return new StrideSchedPolicy;
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// MLFQSchedPolicy::MLFQSchedPolicy
+// 	Initialize a multi-level feedback queue, with every level empty.
+//----------------------------------------------------------------------
+
+MLFQSchedPolicy::MLFQSchedPolicy()
+{
+    lastBoost = 0;
+}
+
+//----------------------------------------------------------------------
+// MLFQSchedPolicy::Ready
+// 	Queue "t" at the end of its level.  New threads start at the top;
+//	a thread that has just been woken up has been waiting on I/O (or
+//	some other event) rather than using the CPU, so it moves up one.
+//	A thread that was running keeps its level: if it used up its
+//	quantum, Preempt has already moved it down.
+//----------------------------------------------------------------------
+
+void
+MLFQSchedPolicy::Ready(Thread *t, ThreadStatus was)
+{
+    if (was == JUST_CREATED)
+	t->priority = 0;
+    else if (was == BLOCKED && t->priority > 0) {
+	t->priority--;
+	stats->numPriorityBoosts++;
+    }
+    levels[t->priority].Append(t);
+}
+
+//----------------------------------------------------------------------
+// MLFQSchedPolicy::Next
+// 	Dequeue the first thread of the highest level that has one.
+//----------------------------------------------------------------------
+
+Thread *
+MLFQSchedPolicy::Next()
+{
+    for (int i = 0; i < MLFQLevels; i++)
+	if (!levels[i].IsEmpty())
+	    return levels[i].Remove();
+    return NULL;
+}
+
+bool
+MLFQSchedPolicy::Remove(Thread *t)
+{
+    return levels[t->priority].Remove(t);
+}
+
+bool
+MLFQSchedPolicy::IsEmpty()
+{
+    for (int i = 0; i < MLFQLevels; i++)
+	if (!levels[i].IsEmpty())
+	    return FALSE;
+    return TRUE;
+}
+
+void
+MLFQSchedPolicy::Mapcar(VoidFunctionPtr func)
+{
+    for (int i = 0; i < MLFQLevels; i++)
+	levels[i].Mapcar(func);
+}
+
+//----------------------------------------------------------------------
+// MLFQSchedPolicy::Preempt
+// 	Called on every timer interrupt while somebody is ready.  If it
+//	is time, first move everyone back to the top level.  Then the
+//	running thread gives up the CPU if a thread of a higher level is
+//	waiting, or if it has used up the quantum of its level, in which
+//	case it drops a level -- but then only if somebody is waiting at
+//	its new level or above, since Yield would otherwise run a thread
+//	from further down ahead of it.
+//----------------------------------------------------------------------
+
+bool
+MLFQSchedPolicy::Preempt(Thread *running)
+{
+    int quantum = MLFQQuantum << running->priority;
+    int i;
+
+    if (stats->totalTicks - lastBoost >= MLFQBoostInterval)
+	Boost(running);
+    if (stats->totalTicks - running->sliceStart >= quantum) {
+	if (running->priority < MLFQLevels - 1) {
+	    running->priority++;
+	    stats->numPriorityDrops++;
+	}
+	running->sliceStart = stats->totalTicks;	// a fresh quantum
+	for (i = 0; i <= running->priority; i++)
+	    if (!levels[i].IsEmpty())
+		return TRUE;
+	return FALSE;
+    }
+    for (i = 0; i < running->priority; i++)
+	if (!levels[i].IsEmpty())
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// MLFQSchedPolicy::Boost
+// 	Move every thread, running or ready, back to the top level, so
+//	that CPU-bound threads that have sunk to the bottom get to run
+//	now and then, however busy the upper levels are.
+//----------------------------------------------------------------------
+
+void
+MLFQSchedPolicy::Boost(Thread *running)
+{
+    Thread *t;
+
+    lastBoost = stats->totalTicks;
+    running->priority = 0;
+    running->sliceStart = stats->totalTicks;	// a fresh quantum
+    for (int i = 1; i < MLFQLevels; i++)
+	while ((t = levels[i].Remove()) != NULL) {
+	    t->priority = 0;
+	    levels[0].Append(t);
+	}
+    stats->numAgingBoosts++;
+}
+
+//----------------------------------------------------------------------
+// StrideClient::StrideClient
+// 	Start keeping figures for thread "t", which isn't competing yet.
+//----------------------------------------------------------------------
+
+StrideClient::StrideClient(Thread *t)
+{
+    thread = t;
+    name = t->getName();
+    id = -1;
+#ifdef USER_PROGRAM
+    if (t->space != NULL && t->space->getPCB() != NULL)
+	id = t->space->getPID();
+#endif
+    tickets = t->tickets;
+    stride = StrideOne / tickets;
+    pass = 0;
+    heapIndex = -1;
+    competing = FALSE;
+    startVirtual = entitled = 0;
+    cpuTicks = 0;
+    next = NULL;
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::StrideSchedPolicy
+// 	Initialize a stride scheduler with nobody ready.
+//----------------------------------------------------------------------
+
+StrideSchedPolicy::StrideSchedPolicy()
+{
+    capacity = 16;
+    heap = new StrideClient*[capacity];
+    size = 0;
+    totalTickets = 0;
+    virtualTime = 0;
+    lastCharge = 0;
+    running = NULL;
+    firstClient = lastClient = NULL;
+}
+
+StrideSchedPolicy::~StrideSchedPolicy()
+{
+    StrideClient *c;
+
+    while ((c = firstClient) != NULL) {
+	firstClient = c->next;
+	if (c->thread != NULL)
+	    c->thread->strideClient = NULL;
+	delete c;
+    }
+    delete [] heap;
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::ClientOf
+// 	Return thread "t"'s figures, making them on first use.
+//----------------------------------------------------------------------
+
+StrideClient *
+StrideSchedPolicy::ClientOf(Thread *t)
+{
+    StrideClient *c = t->strideClient;
+
+    if (c == NULL) {
+	c = t->strideClient = new StrideClient(t);
+	if (lastClient != NULL)
+	    lastClient->next = c;
+	else
+	    firstClient = c;
+	lastClient = c;
+    }
+    return c;
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::CatchUp
+// 	Charge the running thread for the CPU time it has used since we
+//	last looked, in its pass and in virtual time.  If it has since
+//	blocked (or finished), it stops competing.  Called on the way in
+//	to everything that looks at the pass values or the tickets.
+//----------------------------------------------------------------------
+
+void
+StrideSchedPolicy::CatchUp()
+{
+    int ticks = stats->totalTicks - lastCharge;
+
+    lastCharge = stats->totalTicks;
+    if (running == NULL && currentThread->getStatus() == RUNNING) {
+	running = ClientOf(currentThread);	// running since before we
+	if (!running->competing)		// heard of it (main, say)
+	    Join(running);
+    }
+    if (running == NULL)
+	return;
+    if (ticks > 0) {
+	running->cpuTicks += ticks;
+	running->pass += (unsigned) running->stride * (unsigned) ticks;
+	virtualTime += (double) ticks / totalTickets;
+    }
+    if (running->thread == NULL || running->thread->getStatus() == BLOCKED) {
+	Leave(running);
+	running = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::Join
+// StrideSchedPolicy::Leave
+// 	Start and stop competing for the CPU.  A thread that joins starts
+//	level with the lowest pass among the others, so that it can
+//	neither bank credit while it was blocked, nor be made to catch up
+//	with threads that ran meanwhile.
+//----------------------------------------------------------------------
+
+void
+StrideSchedPolicy::Join(StrideClient *c)
+{
+    if (size > 0)
+	c->pass = heap[0]->pass;
+    if (running != NULL && running != c && running->competing &&
+	    (size == 0 || Earlier(running, heap[0])))
+	c->pass = running->pass;
+    c->competing = TRUE;
+    c->startVirtual = virtualTime;
+    totalTickets += c->tickets;
+}
+
+void
+StrideSchedPolicy::Leave(StrideClient *c)
+{
+    Settle(c);
+    c->competing = FALSE;
+    totalTickets -= c->tickets;
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::Settle
+// 	Credit "c" with its tickets' worth of the CPU time since we last
+//	settled, if it has been competing.
+//----------------------------------------------------------------------
+
+void
+StrideSchedPolicy::Settle(StrideClient *c)
+{
+    if (c->competing)
+	c->entitled += c->tickets * (virtualTime - c->startVirtual);
+    c->startVirtual = virtualTime;
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::Ready
+// 	Queue "t" by its pass.  A thread that was running is still
+//	competing; one that is new or has been woken up joins in.
+//----------------------------------------------------------------------
+
+void
+StrideSchedPolicy::Ready(Thread *t, ThreadStatus was)
+{
+    StrideClient *c;
+
+    CatchUp();
+    c = ClientOf(t);
+    if (!c->competing)
+	Join(c);
+    Insert(c);
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::Next
+// 	Dequeue the ready thread with the lowest pass, and make it the
+//	one that is charged from now on.
+//----------------------------------------------------------------------
+
+Thread *
+StrideSchedPolicy::Next()
+{
+    StrideClient *c;
+
+    CatchUp();
+    if (size == 0)
+	return NULL;
+    c = heap[0];
+    Delete(c);
+    running = c;
+    return c->thread;
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::Preempt
+// 	Called on every timer interrupt while somebody is ready.  The
+//	running thread "t" gives up the CPU only once some ready thread's
+//	pass is lower than its own.  (Yield picks the next thread before
+//	queuing the running one, so saying yes whenever anyone is ready
+//	would make the threads take turns, whatever their tickets.)
+//----------------------------------------------------------------------
+
+bool
+StrideSchedPolicy::Preempt(Thread *t)
+{
+    CatchUp();
+    return (running != NULL && size > 0 && Earlier(heap[0], running));
+}
+
+bool
+StrideSchedPolicy::Remove(Thread *t)
+{
+    StrideClient *c = t->strideClient;
+
+    if (c == NULL || c->heapIndex == -1)
+	return FALSE;
+    CatchUp();
+    Delete(c);
+    Leave(c);
+    return TRUE;
+}
+
+void
+StrideSchedPolicy::Mapcar(VoidFunctionPtr func)
+{
+    for (int i = 0; i < size; i++)
+	(*func)((int) heap[i]->thread);
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::SetTickets
+// 	Give thread "t" "n" tickets.  Its entitlement so far is settled
+//	at the old rate first.
+//----------------------------------------------------------------------
+
+void
+StrideSchedPolicy::SetTickets(Thread *t, int n)
+{
+    StrideClient *c;
+
+    CatchUp();
+    t->tickets = n;
+    c = t->strideClient;
+    if (c == NULL)
+	return;
+    Settle(c);
+    if (c->competing)
+	totalTickets += n - c->tickets;
+    c->tickets = n;
+    c->stride = StrideOne / n;
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::Insert
+// StrideSchedPolicy::Delete
+// StrideSchedPolicy::Sift
+// 	The ready heap, ordered by pass: as for EventQueue (interrupt.h).
+//----------------------------------------------------------------------
+
+void
+StrideSchedPolicy::Insert(StrideClient *c)
+{
+    int i;
+
+    if (size == capacity) {		// out of room, double the heap
+	StrideClient **bigger = new StrideClient*[2 * capacity];
+
+	for (i = 0; i < size; i++)
+	    bigger[i] = heap[i];
+	delete [] heap;
+	heap = bigger;
+	capacity *= 2;
+    }
+    Sift(c, size++);
+}
+
+void
+StrideSchedPolicy::Delete(StrideClient *c)
+{
+    StrideClient *last;
+
+    ASSERT(c->heapIndex >= 0 && c->heapIndex < size && heap[c->heapIndex] == c);
+    last = heap[--size];
+    if (last != c)
+	Sift(last, c->heapIndex);
+    c->heapIndex = -1;
+}
+
+void
+StrideSchedPolicy::Sift(StrideClient *c, int i)
+{
+    int parent, child;
+
+    for (; i > 0; i = parent) {
+	parent = (i - 1) / 2;
+	if (!Earlier(c, heap[parent]))
+	    break;
+	Place(heap[parent], i);
+    }
+    for (; (child = 2 * i + 1) < size; i = child) {
+	if ((child + 1 < size) && Earlier(heap[child + 1], heap[child]))
+	    child++;
+	if (!Earlier(heap[child], c))
+	    break;
+	Place(heap[child], i);
+    }
+    Place(c, i);
+}
+
+//----------------------------------------------------------------------
+// StrideSchedPolicy::PrintStats
+// 	Print, for every thread that ever competed, the share of the CPU
+//	it got, next to the share its tickets entitled it to.
+//----------------------------------------------------------------------
+
+void
+StrideSchedPolicy::PrintStats()
+{
+    StrideClient *c;
+    double entitled = 0;
+    int used = 0;
+
+    CatchUp();
+    for (c = firstClient; c != NULL; c = c->next) {
+	Settle(c);
+	entitled += c->entitled;
+	used += c->cpuTicks;
+    }
+    if (used == 0 || entitled <= 0)
+	return;
+    printf("CPU shares (stride):\n");
+    for (c = firstClient; c != NULL; c = c->next) {
+	if (c->id != -1)
+	    printf("  [%d]", c->id);
+	else
+	    printf("  %s", c->name);
+	printf(": tickets %d, ticks %d, got %.1f%%, entitled to %.1f%%\n",
+	    c->tickets, c->cpuTicks, 100.0 * c->cpuTicks / used,
+	    100.0 * c->entitled / entitled);
+    }
+}
@@ -0,0 +1,176 @@
+// schedpolicy.h 
+//	Scheduling policies: the order in which the Scheduler runs the
+//	threads on the ready list, and when the timer should take the
+//	CPU away from the running thread.  Picked at boot with -sp.
+//
+//	  fifo -- one queue, first come first served; with -rs, the
+//		  running thread is preempted on every timer interrupt
+//	  mlfq -- multi-level feedback queue: a thread that uses up its
+//		  quantum drops a level, where the quantum is longer; one
+//		  that wakes up after blocking (on I/O, say) moves up a
+//		  level; and every so often everyone is moved back to the
+//		  top, so that nothing starves
+//	  stride -- proportional share: each thread gets CPU time in
+//		  proportion to its tickets, out of the tickets of all
+//		  the threads that want the CPU
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDPOLICY_H
+#define SCHEDPOLICY_H
+
+#include "copyright.h"
+#include "thread.h"
+#include "scheduler.h"
+#include "stats.h"
+
+class SchedPolicy {
+  public:
+    virtual ~SchedPolicy() {}
+    virtual char *Name() = 0;
+
+    virtual void Ready(Thread *t, ThreadStatus was) = 0;
+				// queue "t", which was "was": JUST_CREATED,
+				// RUNNING (it yielded or was preempted),
+				// or BLOCKED (it has just been woken up)
+    virtual Thread *Next() = 0;	// dequeue the thread to run next,
+				// or return NULL if none is ready
+    virtual bool Remove(Thread *t) = 0;
+				// dequeue "t"; FALSE if it isn't queued
+    virtual bool IsEmpty() = 0;
+    virtual void Mapcar(VoidFunctionPtr func) = 0;
+				// apply "func" to every queued thread
+
+    virtual bool NeedsTimer() { return FALSE; }
+				// must the timer run, even without -rs?
+    virtual bool Preempt(Thread *running) { return TRUE; }
+				// on a timer interrupt: should "running"
+				// give up the CPU to a ready thread?
+    virtual void SetTickets(Thread *t, int n) { t->tickets = n; }
+    virtual void PrintStats() {}	// at Halt
+};
+
+class FIFOSchedPolicy : public SchedPolicy {
+  public:
+    char *Name() { return "fifo"; }
+    void Ready(Thread *t, ThreadStatus was) { readyList.Append(t); }
+    Thread *Next() { return readyList.Remove(); }
+    bool Remove(Thread *t) { return readyList.Remove(t); }
+    bool IsEmpty() { return readyList.IsEmpty(); }
+    void Mapcar(VoidFunctionPtr func) { readyList.Mapcar(func); }
+
+  private:
+    ThreadQueue readyList;
+};
+
+#define MLFQLevels	3		// number of priority levels
+#define MLFQQuantum	TimerTicks	// quantum at the top level; it
+					// doubles at each level down
+#define MLFQBoostInterval (50 * TimerTicks)	// how often everyone goes
+					// back to the top level
+
+class MLFQSchedPolicy : public SchedPolicy {
+  public:
+    MLFQSchedPolicy();
+    char *Name() { return "mlfq"; }
+    void Ready(Thread *t, ThreadStatus was);
+    Thread *Next();
+    bool Remove(Thread *t);
+    bool IsEmpty();
+    void Mapcar(VoidFunctionPtr func);
+    bool NeedsTimer() { return TRUE; }	// the quanta are timed by it
+    bool Preempt(Thread *running);
+
+  private:
+    ThreadQueue levels[MLFQLevels];	// levels[0] runs first
+    int lastBoost;			// when everyone last went to the top
+
+    void Boost(Thread *running);	// move everyone to the top level
+};
+
+// Stride scheduling (Waldspurger and Weihl): every thread has a
+// "pass", and the ready thread with the lowest pass runs next.  Running
+// advances a thread's pass by its "stride", which is inversely
+// proportional to its tickets, times the ticks it ran for; so a thread
+// with twice the tickets advances half as fast, and runs twice as much.
+//
+// For the report at Halt, we also work out how much CPU time each
+// thread was entitled to: every tick of CPU time is shared out among
+// the threads competing for it at the time, in proportion to their
+// tickets.  Rather than visit them all on every tick, we keep a
+// "virtual time" that advances by 1 / (total tickets) for each tick
+// of CPU time, so that a thread's entitlement over any stretch is its
+// tickets times the virtual time that passed.
+//
+// StrideOne is large so that strides stay precise even at MaxTickets
+// (where the stride is still about a hundred).  Passes are compared
+// modulo 2^32, which holds as long as no thread is charged for more
+// than 2^31 / StrideOne (2048) ticks at once; while others are ready,
+// the timer sees to that.
+
+#define StrideOne	(1 << 20)	// the stride of a single ticket
+
+class StrideClient {
+  public:
+    StrideClient(Thread *t);
+
+    Thread *thread;		// NULL once it has finished
+    char *name;			// of the thread
+    int id;			// process id, or -1 for a kernel thread
+    int tickets;		// the thread's tickets, as we know them
+    int stride;			// StrideOne / tickets
+    unsigned int pass;		// compared modulo 2^32, see Earlier
+    int heapIndex;		// where it is in the ready heap, or -1
+    bool competing;		// running or ready
+    double startVirtual;	// virtual time when we last settled
+    double entitled;		// CPU ticks the tickets were worth
+    int cpuTicks;		// CPU ticks actually used
+    StrideClient *next;		// all clients, for the report
+};
+
+class StrideSchedPolicy : public SchedPolicy {
+  public:
+    StrideSchedPolicy();
+    ~StrideSchedPolicy();
+    char *Name() { return "stride"; }
+    void Ready(Thread *t, ThreadStatus was);
+    Thread *Next();
+    bool Remove(Thread *t);
+    bool IsEmpty() { return (size == 0); }
+    void Mapcar(VoidFunctionPtr func);
+    bool NeedsTimer() { return TRUE; }	// to take turns at all
+    bool Preempt(Thread *t);
+    void SetTickets(Thread *t, int n);
+    void PrintStats();
+
+  private:
+    StrideClient **heap;		// ready threads, lowest pass first
+    int size;
+    int capacity;
+    int totalTickets;			// of the competing threads
+    double virtualTime;			// see above
+    int lastCharge;			// when CatchUp last ran
+    StrideClient *running;		// whose turn it is, if competing
+    StrideClient *firstClient;		// all the clients, oldest first
+    StrideClient *lastClient;
+
+    StrideClient *ClientOf(Thread *t);	// make one if need be
+    void CatchUp();			// charge the running thread
+    void Join(StrideClient *c);		// start, and stop, competing
+    void Leave(StrideClient *c);
+    void Settle(StrideClient *c);	// bring "entitled" up to date
+    void Insert(StrideClient *c);	// heap operations
+    void Delete(StrideClient *c);
+    void Sift(StrideClient *c, int i);
+    void Place(StrideClient *c, int i) { heap[i] = c; c->heapIndex = i; }
+    bool Earlier(StrideClient *a, StrideClient *b) {
+	return (int) (a->pass - b->pass) < 0;
+    }
+};
+
+extern SchedPolicy *NewSchedPolicy(char *name);
+					// by name (see above), or NULL
+
+#endif // SCHEDPOLICY_H
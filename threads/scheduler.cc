@@ -11,8 +11,9 @@
 //	end up calling FindNextToRun(), and that would put us in an 
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	The order in which ready threads run, and when the timer takes
+//	the CPU away, is up to the scheduling policy (fifo, mlfq or
+//	stride; see schedpolicy.h).
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -20,16 +21,19 @@
 
 #include "copyright.h"
 #include "scheduler.h"
+#include "schedpolicy.h"
 #include "system.h"
 
 //----------------------------------------------------------------------
 // Scheduler::Scheduler
 // 	Initialize the list of ready but not running threads to empty.
+//
+//	"p" is the scheduling policy, which we now own
 //----------------------------------------------------------------------
 
-Scheduler::Scheduler()
+Scheduler::Scheduler(SchedPolicy *p)
 { 
-    readyList = new List; 
+    policy = p; 
     killThread = NULL;
 } 
 
@@ -40,7 +44,7 @@ Scheduler::Scheduler()
 
 Scheduler::~Scheduler()
 { 
-    delete readyList; 
+    delete policy; 
 } 
 
 //----------------------------------------------------------------------
@@ -54,10 +58,15 @@ Scheduler::~Scheduler()
 void
 Scheduler::ReadyToRun (Thread *thread)
 {
+    ThreadStatus was = thread->getStatus();
+
     DEBUG('t', "Putting thread %s on ready list.\n", thread->getName());
 
     thread->setStatus(READY);
-    readyList->Append((void *)thread);
+    thread->readySince = stats->totalTicks;
+    policy->Ready(thread, was);
+    if (timer != NULL && !timer->IsEnabled())
+	timer->Enable();		// someone to switch to, now
 }
 
 //----------------------------------------------------------------------
@@ -71,52 +80,55 @@ Scheduler::ReadyToRun (Thread *thread)
 Thread *
 Scheduler::FindNextToRun ()
 {
-    return (Thread *)readyList->Remove();
+    Thread *next = policy->Next();
+
+    if (timer != NULL && policy->IsEmpty())
+	timer->Disable();		// nobody left to switch to
+    return next;
 }
 
-//External added code
-//
-//Remove a thread from the scheduler and put them back in order
-void 
-Scheduler::RemoveThisThread(Thread* input)
+//----------------------------------------------------------------------
+// Scheduler::RemoveThisThread
+// 	Take thread "t" off the ready list, for Kill.  Returns FALSE if
+//	it wasn't on the ready list (because it is blocked, say).
+//----------------------------------------------------------------------
+
+bool
+Scheduler::RemoveThisThread(Thread *t)
 {
-    Thread* temp;
-    Thread* first;
-    bool fix = true;
-    bool done=false;
+    if (!policy->Remove(t))
+	return FALSE;
+    if (timer != NULL && policy->IsEmpty())
+	timer->Disable();
+    return TRUE;
+}
 
+//----------------------------------------------------------------------
+// Scheduler::SetTickets
+// 	Change thread "t"'s share of the CPU, for the stride scheduler.
+//----------------------------------------------------------------------
 
-    if((Thread*)readyList->Top() != input) 
-    {
-    	first = (Thread *)readyList->Top();
-    }
-    else
-    {
-	fix = false;
-	done = true;
-    	temp = (Thread *)readyList->Remove();
-	//delete temp;
-    }
+void
+Scheduler::SetTickets(Thread *t, int n)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    //remove the input thread
-    if(done == false)
-    {
-    	temp = (Thread *)readyList->Remove();
-    	while(temp != input)
-    	{
-    		readyList->Append((void *)temp);
-    		temp = (Thread *)readyList->Remove();
-    	}
-	//delete temp;
-   	 //make sure list is back in the right order
-    	while(((Thread*)readyList->Top() != first) && (fix == true))
-    	{
-    		temp = (Thread *)readyList->Remove();
-    		readyList->Append((void *)temp);
-    	}
-    }
+    ASSERT(n >= 1 && n <= MaxTickets);
+    policy->SetTickets(t, n);
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ShouldPreempt
+// 	Called from the timer interrupt handler: let the policy decide
+//	whether the running thread's time is up.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::ShouldPreempt()
+{
+    return policy->Preempt(currentThread);
 }
-//end of External added code
 
 //----------------------------------------------------------------------
 // Scheduler::Run
@@ -143,6 +155,7 @@ void
 Scheduler::Run (Thread *nextThread)
 {
     Thread *oldThread = currentThread;
+    int wait;
     
 #ifdef USER_PROGRAM			// ignore until running user programs 
     if (currentThread->space != NULL) {	// if this thread is a user program,
@@ -154,6 +167,17 @@ Scheduler::Run (Thread *nextThread)
     oldThread->CheckOverflow();		    // check if the old thread
 					    // had an undetected stack overflow
 
+    stats->numContextSwitches++;
+    wait = stats->totalTicks - nextThread->readySince;
+    nextThread->waitTicks += wait;
+    nextThread->numWaits++;
+    if (wait > nextThread->longestWait)
+	nextThread->longestWait = wait;
+    stats->readyWaitTicks += wait;
+    stats->numReadyWaits++;
+    if (wait > stats->longestReadyWait)
+	stats->longestReadyWait = wait;
+    nextThread->sliceStart = stats->totalTicks;
     currentThread = nextThread;		    // switch to the next thread
     currentThread->setStatus(RUNNING);      // nextThread is now running
     
@@ -206,5 +230,5 @@ void
 Scheduler::Print()
 {
     printf("Ready list contents:\n");
-    readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
+    policy->Mapcar((VoidFunctionPtr) ThreadPrint);
 }
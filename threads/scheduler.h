@@ -16,10 +16,19 @@
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
 // thread is running, and which threads are ready but not running.
+//
+// Which ready thread runs next is up to a SchedPolicy (schedpolicy.h).
+//
+// When there is a timer (with -rs, or for a policy that needs it), the
+// scheduler also starts and stops it: it only runs while somebody is
+// waiting on the ready list, since otherwise there is nobody to switch
+// to.
+
+class SchedPolicy;
 
 class Scheduler {
   public:
-    Scheduler();			// Initialize list of ready threads 
+    Scheduler(SchedPolicy *p);		// Initialize list of ready threads 
     ~Scheduler();			// De-allocate ready list
 
     void ReadyToRun(Thread* thread);	// Thread can be dispatched.
@@ -27,13 +36,18 @@ class Scheduler {
 					// list, if any, and return thread.
     void Run(Thread* nextThread);	// Cause nextThread to start running
     void Print();			// Print contents of ready list
-    void RemoveThisThread(Thread *);
+    bool RemoveThisThread(Thread *t);	// take "t" off the ready list;
+					// FALSE if it wasn't on it
+    bool ShouldPreempt();		// on a timer interrupt: should the
+					// running thread yield?
+    SchedPolicy *Policy() { return policy; }
+    void SetTickets(Thread *t, int n);	// give "t" "n" tickets
     void setThreadDestroy(Thread *);
     
   private:
-    List *readyList;  		// queue of threads that are ready to run,
+    SchedPolicy *policy;		// keeps the threads that are ready
+					// to run, but not running
     Thread* killThread;
-				// but not running
 };
 
 #endif // SCHEDULER_H
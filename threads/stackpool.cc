@@ -0,0 +1,83 @@
+// stackpool.cc 
+//	Routines to recycle thread execution stacks: see stackpool.h.
+//
+//	Get and Put don't enable interrupts, so they can't be preempted
+//	half way.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "stackpool.h"
+#include "thread.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// StackPool::StackPool
+// 	Initialize a pool that keeps up to "maxIdle" idle stacks; a cap
+//	of 0 gives every stack straight back to the host.  "warm" stacks
+//	(up to the cap) are made now, rather than on first use.
+//----------------------------------------------------------------------
+
+StackPool::StackPool(int maxIdle, int warm)
+{
+    int numWarm = min(warm, maxIdle);
+
+    ASSERT(maxIdle >= 0 && warm >= 0);
+    cap = maxIdle;
+    idle = new int*[cap + 1];		// never empty, for new
+    numIdle = 0;
+    for (; numIdle < numWarm; numIdle++) {
+	idle[numIdle] = (int *) AllocBoundedArray(StackSize * sizeof(int));
+	stats->numStacksMade++;
+    }
+}
+
+//----------------------------------------------------------------------
+// StackPool::~StackPool
+// 	Give the idle stacks back to the host.  Stacks still in use by
+//	threads are not ours to free.
+//----------------------------------------------------------------------
+
+StackPool::~StackPool()
+{
+    while (numIdle > 0)
+	DeallocBoundedArray((char *) idle[--numIdle], StackSize * sizeof(int));
+    delete [] idle;
+}
+
+//----------------------------------------------------------------------
+// StackPool::Get
+// 	Return a stack of StackSize words, the most recently idle one
+//	if there is any (it is the most likely to be in the host's
+//	cache), otherwise a new one.
+//----------------------------------------------------------------------
+
+int *
+StackPool::Get()
+{
+    if (numIdle > 0) {
+	stats->numStacksReused++;
+	return idle[--numIdle];
+    }
+    stats->numStacksMade++;
+    return (int *) AllocBoundedArray(StackSize * sizeof(int));
+}
+
+//----------------------------------------------------------------------
+// StackPool::Put
+// 	Take back "stack", which its thread is done with, or unmap it
+//	if the pool is full.
+//----------------------------------------------------------------------
+
+void
+StackPool::Put(int *stack)
+{
+    if (numIdle < cap) {
+	idle[numIdle++] = stack;
+	return;
+    }
+    stats->numStacksFreed++;
+    DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+}
@@ -0,0 +1,48 @@
+// stackpool.h 
+//	Data structures for recycling thread execution stacks.
+//
+//	Every stack is a bounded array (see AllocBoundedArray in
+//	sysdep.cc), with guard pages either side to catch overflow.
+//	Making one costs several host system calls, and so does
+//	unmapping it, which adds up when threads come and go quickly,
+//	as they do with Fork and Exit.  So when a thread is deleted its
+//	stack goes back to a pool, guard pages and all, and the next
+//	thread to Fork takes it from there.
+//
+//	The pool keeps at most "cap" idle stacks; beyond that they are
+//	unmapped, so a burst of threads does not tie up memory for
+//	good.  The pool can also be filled at boot, so that the first
+//	threads don't pay either.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef STACKPOOL_H
+#define STACKPOOL_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define DefaultStackPoolCap	16	// idle stacks kept, by default
+
+// The following class defines a pool of idle thread stacks, each
+// StackSize words long.
+
+class StackPool {
+  public:
+    StackPool(int maxIdle, int warm);	// keep up to "maxIdle" idle stacks,
+					// and start with "warm" of them
+    ~StackPool();			// unmap the idle stacks
+
+    int *Get();				// a stack, from the pool if possible
+    void Put(int *stack);		// done with "stack"
+    int NumIdle() { return numIdle; }
+
+  private:
+    int **idle;				// the idle stacks
+    int numIdle;
+    int cap;				// size of "idle"
+};
+
+#endif // STACKPOOL_H
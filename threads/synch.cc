@@ -37,7 +37,6 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List;
 }
 
 //----------------------------------------------------------------------
@@ -48,7 +47,6 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 
 Semaphore::~Semaphore()
 {
-    delete queue;
 }
 
 //----------------------------------------------------------------------
@@ -67,8 +65,8 @@ Semaphore::P()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	// disable interrupts
     
     while (value == 0) { 			// semaphore not available
-	queue->Append((void *)currentThread);	// so go to sleep
-	currentThread->Sleep();
+	queue.Append(&currentThread->queueLink, currentThread);
+	currentThread->Sleep();			// so go to sleep
     } 
     value--; 					// semaphore available, 
 						// consume its value
@@ -90,7 +88,7 @@ Semaphore::V()
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    thread = (Thread *)queue->Remove();
+    thread = (Thread *) queue.RemoveFirst();
     if (thread != NULL)	   // make thread ready, consuming the V immediately
 	scheduler->ReadyToRun(thread);
     value++;
@@ -104,13 +102,11 @@ Semaphore::V()
 Lock::Lock(char* debugName) 
 {
 	name = debugName;
-	queue = new List;
 	lockthread = NULL;
 }
 
 Lock::~Lock() 
 {
-	delete queue; 
 }
 
 void Lock::Acquire() 
@@ -123,7 +119,7 @@ void Lock::Acquire()
 	}
 	else if(lockthread != currentThread)
 	{
-		queue->Append((void *)currentThread);
+		queue.Append(&currentThread->queueLink, currentThread);
 		currentThread->Sleep();
 	}
 	(void) interrupt->SetLevel(oldLevel);
@@ -135,7 +131,7 @@ void Lock::Release()
 	//make sure the right thread is being removed
 	if(lockthread == currentThread)
 	{
-		lockthread = (Thread *)queue->Remove();
+		lockthread = (Thread *) queue.RemoveFirst();
 		if(lockthread != NULL)
 			scheduler->ReadyToRun(lockthread);
 	}
@@ -153,12 +149,10 @@ bool Lock::isHeldByCurrentThread()
 Condition::Condition(char* debugName) 
 { 
     name = debugName;
-    queue = new List;
 }
 
 Condition::~Condition() 
 { 
-    delete queue;
 }
 
 void Condition::Wait(Lock* conditionLock) 
@@ -166,7 +160,7 @@ void Condition::Wait(Lock* conditionLock)
 
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
     conditionLock->Release();
-    queue->Append((void *) currentThread);
+    queue.Append(&currentThread->queueLink, currentThread);
     currentThread->Sleep();
     conditionLock->Acquire();
     (void) interrupt->SetLevel(oldLevel);
@@ -176,7 +170,7 @@ void Condition::Wait(Lock* conditionLock)
 void Condition::Signal(Lock* conditionLock) 
 { 
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
-    Thread *w = (Thread *)queue->Remove();
+    Thread *w = (Thread *) queue.RemoveFirst();
     if( w != NULL)
 	scheduler->ReadyToRun(w);
     (void) interrupt->SetLevel(oldLevel);
@@ -185,11 +179,11 @@ void Condition::Signal(Lock* conditionLock)
 void Condition::Broadcast(Lock* conditionLock) 
 { 
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
-    Thread *w = (Thread *)queue->Remove();
+    Thread *w = (Thread *) queue.RemoveFirst();
     while(w != NULL)
     {
 	scheduler->ReadyToRun(w);
-	w = (Thread *)queue->Remove();
+	w = (Thread *) queue.RemoveFirst();
     }
     (void) interrupt->SetLevel(oldLevel);
 
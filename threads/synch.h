@@ -48,7 +48,8 @@ class Semaphore {
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List *queue;       // threads waiting in P() for the value to be > 0
+    LinkList queue;    // threads waiting in P() for the value to be > 0,
+		       // linked through Thread::queueLink
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -79,7 +80,7 @@ class Lock {
 
   private:
     char* name;				// for debugging
-    List *queue;
+    LinkList queue;			// threads waiting in Acquire
     Thread *lockthread;
     // plus some other stuff you'll need to define
 };
@@ -133,7 +134,7 @@ class Condition {
 
   private:
     char* name;
-    List* queue; 
+    LinkList queue;			// threads waiting in Wait
     // plus some other stuff you'll need to define
 };
 #endif // SYNCH_H
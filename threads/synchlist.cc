@@ -1,8 +1,9 @@
 // synchlist.cc
 //	Routines for synchronized access to a list.
 //
-//	Implemented by surrounding the List abstraction
-//	with synchronization routines.
+//	Implemented by surrounding the LinkList abstraction (an
+//	intrusive list, see list.h) with synchronization routines, so
+//	that nothing is allocated as items come and go.
 //
 // 	Implemented in "monitor"-style -- surround each procedure with a
 // 	lock acquire and release pair, using condition signal and wait for
@@ -24,7 +25,6 @@
 
 SynchList::SynchList()
 {
-    list = new List();
     lock = new Lock("list lock"); 
     listEmpty = new Condition("list empty cond");
 }
@@ -36,7 +36,6 @@ SynchList::SynchList()
 
 SynchList::~SynchList()
 { 
-    delete list; 
     delete lock;
     delete listEmpty;
 }
@@ -46,15 +45,16 @@ SynchList::~SynchList()
 //      Append an "item" to the end of the list.  Wake up anyone
 //	waiting for an element to be appended.
 //
+//	"link" is the item's own ListLink, which must not be on a list.
 //	"item" is the thing to put on the list, it can be a pointer to 
 //		anything.
 //----------------------------------------------------------------------
 
 void
-SynchList::Append(void *item)
+SynchList::Append(ListLink *link, void *item)
 {
     lock->Acquire();		// enforce mutual exclusive access to the list 
-    list->Append(item);
+    list.Append(link, item);
     listEmpty->Signal(lock);	// wake up a waiter, if any
     lock->Release();
 }
@@ -73,9 +73,9 @@ SynchList::Remove()
     void *item;
 
     lock->Acquire();			// enforce mutual exclusion
-    while (list->IsEmpty())
+    while (list.IsEmpty())
 	listEmpty->Wait(lock);		// wait until list isn't empty
-    item = list->Remove();
+    item = list.RemoveFirst();
     ASSERT(item != NULL);
     lock->Release();
     return item;
@@ -93,6 +93,6 @@ void
 SynchList::Mapcar(VoidFunctionPtr func)
 { 
     lock->Acquire(); 
-    list->Mapcar(func);
+    list.Mapcar(func);
     lock->Release(); 
 }
@@ -1,8 +1,9 @@
 // synchlist.h 
 //	Data structures for synchronized access to a list.
 //
-//	Implemented by surrounding the List abstraction
-//	with synchronization routines.
+//	Implemented by surrounding the LinkList abstraction (an
+//	intrusive list, see list.h) with synchronization routines, so
+//	that nothing is allocated as items come and go.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -26,15 +27,17 @@ class SynchList {
     SynchList();		// initialize a synchronized list
     ~SynchList();		// de-allocate a synchronized list
 
-    void Append(void *item);	// append item to the end of the list,
-				// and wake up any thread waiting in remove
+    void Append(ListLink *link, void *item);
+				// append item to the end of the list,
+				// through its "link", and wake up any
+				// thread waiting in remove
     void *Remove();		// remove the first item from the front of
 				// the list, waiting if the list is empty
 				// apply function to every item in the list
     void Mapcar(VoidFunctionPtr func);
 
   private:
-    List *list;			// the unsynchronized list
+    LinkList list;		// the unsynchronized list
     Lock *lock;			// enforce mutual exclusive access to the list
     Condition *listEmpty;	// wait in Remove if the list is empty
 };
@@ -7,6 +7,13 @@
 
 #include "copyright.h"
 #include "system.h"
+#include "schedpolicy.h"
+#ifdef USER_PROGRAM
+#include "addrspace.h"
+#endif
+#ifdef VM
+#include "replace.h"
+#endif
 
 // This defines *all* of the global data structures used by Nachos.
 // These are all initialized and de-allocated by this file.
@@ -18,6 +25,8 @@ Interrupt *interrupt;			// interrupt status
 Statistics *stats;			// performance metrics
 Timer *timer;				// the hardware timer device,
 					// for invoking context switches
+Alarm *alarmClock;			// for threads that want to sleep
+StackPool *stackPool;			// stacks of threads that have finished
 
 #ifdef FILESYS_NEEDED
 FileSystem  *fileSystem;
@@ -32,9 +41,16 @@ Machine *machine;	// user program memory and registers
 pid *pid_manager;
 memMan *mans_man;
 Lock *memLock;
+Lock *pagingLock;
 pcbManager *pcbMan;
 #endif
 
+#ifdef VM
+CoreMap *coreMap;
+SwapSpace *swapSpace;
+PageoutDaemon *pageoutDaemon;
+#endif
+
 #ifdef NETWORK
 PostOffice *postOffice;
 #endif
@@ -51,6 +67,11 @@ extern void Cleanup();
 //	This routine is called each time there is a timer interrupt,
 //	with interrupts disabled.
 //
+//	The scheduler only keeps the timer running while there is a
+//	thread on the ready list (see Scheduler::ReadyToRun), so every
+//	interrupt here has somebody to switch to; whether to do so is up
+//	to the scheduling policy.
+//
 //	Note that instead of calling Yield() directly (which would
 //	suspend the interrupt handler, not the interrupted thread
 //	which is what we wanted to context switch), we set a flag
@@ -64,7 +85,8 @@ extern void Cleanup();
 static void
 TimerInterruptHandler(int dummy)
 {
-    if (interrupt->getStatus() != IdleMode)
+    stats->numTimerInterrupts++;
+    if (interrupt->getStatus() != IdleMode && scheduler->ShouldPreempt())
 	interrupt->YieldOnReturn();
 }
 
@@ -84,9 +106,22 @@ Initialize(int argc, char **argv)
     int argCount;
     char* debugArgs = "";
     bool randomYield = FALSE;
+    char *schedPolicy = "fifo";		// scheduling policy
+    SchedPolicy *sched;
+    int stackPoolCap = DefaultStackPoolCap;	// idle thread stacks kept
+    int stackPoolWarm = 0;			// and made at boot
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+    bool threadedCode = FALSE;	// run user code a basic block at a time
+    int physPages = DefaultPhysPages;	// size of main memory, in frames
+    int execCachePages = DefaultExecCachePages;	// for idle programs
+    char *syscallDump = NULL;		// file for system call figures
+#endif
+#ifdef VM
+    char *replacement = "clock";	// page replacement policy
+    int swapPages = DefaultSwapPages;	// size of swap, in pages
+    int lowWater = -1, highWater = -1;	// pageout daemon watermarks
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
@@ -111,10 +146,57 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-sp")) {
+	    ASSERT(argc > 1);
+	    schedPolicy = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-sc")) {
+	    ASSERT(argc > 1);
+	    stackPoolCap = atoi(*(argv + 1));
+	    ASSERT(stackPoolCap >= 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-sw")) {
+	    ASSERT(argc > 1);
+	    stackPoolWarm = atoi(*(argv + 1));
+	    ASSERT(stackPoolWarm >= 0);
+	    argCount = 2;
 	}
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
 	    debugUserProg = TRUE;
+	else if (!strcmp(*argv, "-bb"))
+	    threadedCode = TRUE;
+	else if (!strcmp(*argv, "-mem")) {
+	    ASSERT(argc > 1);
+	    physPages = atoi(*(argv + 1));
+	    ASSERT(physPages > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-sd")) {
+	    ASSERT(argc > 1);
+	    syscallDump = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-ec")) {
+	    ASSERT(argc > 1);
+	    execCachePages = atoi(*(argv + 1));
+	    argCount = 2;
+	}
+#endif
+#ifdef VM
+	if (!strcmp(*argv, "-rp")) {
+	    ASSERT(argc > 1);
+	    replacement = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-swap")) {
+	    ASSERT(argc > 1);
+	    swapPages = atoi(*(argv + 1));
+	    ASSERT(swapPages > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-wm")) {
+	    ASSERT(argc > 2);
+	    lowWater = atoi(*(argv + 1));
+	    highWater = atoi(*(argv + 2));
+	    argCount = 3;
+	}
 #endif
 #ifdef FILESYS_NEEDED
 	if (!strcmp(*argv, "-f"))
@@ -135,10 +217,23 @@ Initialize(int argc, char **argv)
 
     DebugInit(debugArgs);			// initialize DEBUG messages
     stats = new Statistics();			// collect statistics
+#ifdef USER_PROGRAM
+    stats->syscallDumpFile = syscallDump;
+#endif
     interrupt = new Interrupt;			// start up interrupt handling
-    scheduler = new Scheduler();		// initialize the ready queue
-    if (randomYield)				// start the timer (if needed)
+    sched = NewSchedPolicy(schedPolicy);
+    if (sched == NULL) {
+	printf("Unknown scheduling policy %s\n", schedPolicy);
+	ASSERT(FALSE);
+    }
+    stats->schedPolicy = sched->Name();
+    scheduler = new Scheduler(sched);		// initialize the ready queue
+    if (randomYield || sched->NeedsTimer()) {	// start the timer (if needed)
 	timer = new Timer(TimerInterruptHandler, 0, randomYield);
+	timer->Disable();			// until someone else is ready
+    }
+    alarmClock = new Alarm();
+    stackPool = new StackPool(stackPoolCap, stackPoolWarm);
 
     threadToBeDestroyed = NULL;
 
@@ -152,11 +247,26 @@ Initialize(int argc, char **argv)
     CallOnUserAbort(Cleanup);			// if user hits ctl-C
     
 #ifdef USER_PROGRAM
-    machine = new Machine(debugUserProg);	// this must come first
+    machine = new Machine(debugUserProg, threadedCode, physPages);
+						// this must come first
     pid_manager = new pid();
-    mans_man = new memMan();
+    mans_man = new memMan(machine->numPhysPages);
     memLock = new Lock("memory lock");
+    pagingLock = new Lock("paging lock");
     pcbMan = new pcbManager();
+    ProgramImage::SetCacheBudget(execCachePages);
+#endif
+
+#ifdef VM
+    ReplacementPolicy *policy = NewReplacementPolicy(replacement);
+    if (policy == NULL) {
+	printf("Unknown page replacement policy %s\n", replacement);
+	ASSERT(FALSE);
+    }
+    coreMap = new CoreMap(machine->numPhysPages, policy);
+    swapSpace = new SwapSpace(swapPages);
+    pageoutDaemon = new PageoutDaemon(lowWater, highWater);
+    pageoutDaemon->Start();
 #endif
 
 #ifdef FILESYS
@@ -184,6 +294,11 @@ Cleanup()
     delete postOffice;
 #endif
     
+#ifdef VM
+    delete swapSpace;			// before the file system goes
+    delete coreMap;
+#endif
+
 #ifdef USER_PROGRAM
     delete machine;
 #endif
@@ -196,6 +311,8 @@ Cleanup()
     delete synchDisk;
 #endif
     
+    delete alarmClock;
+    delete stackPool;
     delete timer;
     delete scheduler;
     delete interrupt;
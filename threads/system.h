@@ -15,6 +15,8 @@
 #include "interrupt.h"
 #include "stats.h"
 #include "timer.h"
+#include "alarm.h"
+#include "stackpool.h"
 
 // Initialization and cleanup routines
 extern void Initialize(int argc, char **argv); 	// Initialization,
@@ -28,6 +30,8 @@ extern Scheduler *scheduler;			// the ready list
 extern Interrupt *interrupt;			// interrupt status
 extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
+extern Alarm *alarmClock;			// sleeping threads
+extern StackPool *stackPool;			// idle thread stacks
 
 #ifdef USER_PROGRAM
 #include "machine.h"
@@ -43,11 +47,22 @@ class pcbManager;
 extern memMan *mans_man;
 extern pid *pid_manager;
 extern Lock *memLock;
+extern Lock *pagingLock;	// held while paging in or out, so that
+				// two threads never move the same page
 extern pcbManager *pcbMan;
 //end changed
 
 #endif
 
+#ifdef VM
+#include "../vm/coremap.h"
+#include "../vm/swap.h"
+#include "../vm/pageout.h"
+extern CoreMap *coreMap;	// which pages use each frame
+extern SwapSpace *swapSpace;	// where pages go when memory is full
+extern PageoutDaemon *pageoutDaemon;	// keeps some frames free
+#endif
+
 #ifdef FILESYS_NEEDED 		// FILESYS or FILESYS_STUB 
 #include "filesys.h"
 extern FileSystem  *fileSystem;
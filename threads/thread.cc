@@ -19,6 +19,7 @@
 #include "switch.h"
 #include "synch.h"
 #include "system.h"
+#include "schedpolicy.h"
 
 #define STACK_FENCEPOST 0xdeadbeef	// this is put at the top of the
 					// execution stack, for detecting 
@@ -38,6 +39,11 @@ Thread::Thread(char* threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    priority = 0;
+    tickets = DefaultTickets;
+    strideClient = NULL;
+    sliceStart = readySince = 0;
+    waitTicks = numWaits = longestWait = 0;
 #ifdef USER_PROGRAM
     space = NULL;
 #endif
@@ -45,7 +51,7 @@ Thread::Thread(char* threadName)
 
 //----------------------------------------------------------------------
 // Thread::~Thread
-// 	De-allocate a thread.
+// 	De-allocate a thread.  Its stack goes back to the stack pool.
 //
 // 	NOTE: the current thread *cannot* delete itself directly,
 //	since it is still running on the stack that we need to delete.
@@ -60,8 +66,11 @@ Thread::~Thread()
     DEBUG('t', "Deleting thread \"%s\"\n", name);
 
     ASSERT(this != currentThread);
+    queueLink.Unlink();			// (Kill) blocked on a queue
+    if (strideClient != NULL)
+	strideClient->thread = NULL;	// its figures outlive it
     if (stack != NULL)
-	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+	stackPool->Put(stack);
 }
 
 //----------------------------------------------------------------------
@@ -147,6 +156,8 @@ Thread::Finish ()
     ASSERT(this == currentThread);
     
     DEBUG('t', "Finishing thread \"%s\"\n", getName());
+    DEBUG('t', "Thread \"%s\" waited %d ticks to run, %d times, longest %d\n",
+	  getName(), waitTicks, numWaits, longestWait);
     
     threadToBeDestroyed = currentThread;
     Sleep();					// invokes SWITCH
@@ -252,7 +263,7 @@ void ThreadPrint(int arg){ Thread *t = (Thread *)arg; t->Print(); }
 void
 Thread::StackAllocate (VoidFunctionPtr func, int arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = stackPool->Get();
 
 #ifdef HOST_SNAKE
     // HP stack works from low addresses to high addresses
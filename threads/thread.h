@@ -39,6 +39,7 @@
 
 #include "copyright.h"
 #include "utility.h"
+#include "list.h"
 
 #ifdef USER_PROGRAM
 #include "machine.h"
@@ -56,6 +57,9 @@ class Addrspace;
 // WATCH OUT IF THIS ISN'T BIG ENOUGH!!!!!
 #define StackSize	(4 * 1024)	// in words
 
+#define DefaultTickets	100		// a thread's CPU share, for the
+#define MaxTickets	10000		// stride scheduler (schedpolicy.h)
+
 
 // Thread state
 enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED };
@@ -63,6 +67,8 @@ enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED };
 // external function, dummy routine whose sole job is to call Thread::Print
 extern void ThreadPrint(int arg);	 
 
+class StrideClient;
+
 // The following class defines a "thread control block" -- which
 // represents a single thread of execution.
 //
@@ -100,9 +106,28 @@ class Thread {
     void CheckOverflow();   			// Check if thread has 
 						// overflowed its stack
     void setStatus(ThreadStatus st) { status = st; }
+    ThreadStatus getStatus() { return status; }
     char* getName() { return (name); }
     void Print() { printf("%s, ", name); }
 
+    // links for the ThreadQueue the thread is on, if any: the ready
+    // list, or a semaphore's, lock's or condition's waiters.  A thread
+    // is on at most one at a time, so one link will do.
+    ListLink queueLink;
+
+    // for the scheduling policy (see schedpolicy.h)
+    int priority;			// MLFQ level, 0 being the highest
+    int sliceStart;			// when it last got the CPU
+    int tickets;			// share of the CPU, under stride; set
+					// with Scheduler::SetTickets
+    StrideClient *strideClient;		// stride's figures, or NULL
+
+    // time spent waiting on the ready list
+    int readySince;			// when it last went on it
+    int waitTicks;			// in all
+    int numWaits;			// times it has been on it
+    int longestWait;
+
   private:
     // some of the private data for this class is listed above
     
@@ -131,6 +156,12 @@ class Thread {
 #endif
 };
 
+// The following defines a queue of threads, linked through the threads
+// themselves (Thread::queueLink), so that adding and removing a thread,
+// from either end or from the middle, is O(1) and allocates nothing.
+
+typedef IntrusiveList<Thread, &Thread::queueLink> ThreadQueue;
+
 // Magical machine-dependent routines, defined in switch.s
 
 extern "C" {
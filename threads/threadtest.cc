@@ -12,6 +12,8 @@
 #include "copyright.h"
 #include "system.h"
 
+#include <time.h>
+
 // testnum is set in main.cc
 int testnum = 1;
 
@@ -52,6 +54,189 @@ ThreadTest1()
     SimpleThread(0);
 }
 
+//----------------------------------------------------------------------
+// EventQueueBenchmark
+// 	Stress the pending interrupt queue: keep about a thousand device
+//	interrupts outstanding at random times, and run the clock until
+//	two million of them have fired, replacing each one as it fires.
+//	Checks that interrupts fire in time order and none are lost, and
+//	reports how long the host took.  Run with "nachos -q 2".
+//----------------------------------------------------------------------
+
+static const int BenchOutstanding = 1000;
+static const int BenchEvents = 2000000;
+static int benchScheduled, benchFired, benchLastWhen;
+
+static void
+BenchHandler(int when)
+{
+    ASSERT((when <= stats->totalTicks) && (when >= benchLastWhen));
+    benchLastWhen = when;
+    benchFired++;
+    if (benchScheduled < BenchEvents) {
+	int fromNow = 1 + Random() % (BenchOutstanding * SystemTick);
+
+	interrupt->Schedule(BenchHandler, stats->totalTicks + fromNow,
+				fromNow, DiskInt);
+	benchScheduled++;
+    }
+}
+
+void
+EventQueueBenchmark()
+{
+    int i, fromNow, startTicks = stats->totalTicks;
+    clock_t start = clock();
+    double seconds;
+
+    benchScheduled = benchFired = 0;
+    benchLastWhen = stats->totalTicks;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    for (i = 0; i < BenchOutstanding; i++) {
+	fromNow = 1 + Random() % (BenchOutstanding * SystemTick);
+	interrupt->Schedule(BenchHandler, stats->totalTicks + fromNow,
+				fromNow, DiskInt);
+	benchScheduled++;
+    }
+    (void) interrupt->SetLevel(IntOn);
+    while (benchFired < benchScheduled)
+	interrupt->OneTick();
+    (void) interrupt->SetLevel(oldLevel);
+
+    seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    printf("Event queue: %d interrupts fired in %d ticks, %.2f seconds",
+	benchFired, stats->totalTicks - startTicks, seconds);
+    if (seconds > 0)
+	printf(" (%.0f per second)", benchFired / seconds);
+    printf("\n");
+}
+
+//----------------------------------------------------------------------
+// SleepTest
+// 	Periodic threads on the alarm clock: thread i wakes up every
+//	(i + 1) * 500 ticks, five times, and checks it didn't wake early.
+//	Nobody is ever on the ready list while they all sleep, so the
+//	machine idles straight through to the next wakeup.  Run with
+//	"nachos -q 3".
+//----------------------------------------------------------------------
+
+static const int SleepThreads = 4;
+static const int SleepPeriod = 500;
+
+static void
+PeriodicThread(int which)
+{
+    int n, due;
+
+    for (n = 0; n < 5; n++) {
+	due = stats->totalTicks + (which + 1) * SleepPeriod;
+	alarmClock->Pause((which + 1) * SleepPeriod);
+	ASSERT(stats->totalTicks >= due);
+	printf("*** thread %d woke at %d (due %d)\n", which, 
+		stats->totalTicks, due);
+    }
+}
+
+void
+SleepTest()
+{
+    int i;
+
+    for (i = 1; i < SleepThreads; i++) {
+	Thread *t = new Thread("sleeper");
+	t->Fork(PeriodicThread, i);
+    }
+    PeriodicThread(0);
+}
+
+//----------------------------------------------------------------------
+// ReadyQueueBenchmark
+// 	Stress removal from the middle of the ready list, as Kill does:
+//	keep a few thousand threads ready, and over and over take a
+//	random one off and put it back at the end.  The threads are never
+//	run, so they need no stacks.  Checks that the queue keeps its
+//	length, and reports how long the host took.  Run with
+//	"nachos -q 4".
+//----------------------------------------------------------------------
+
+static const int BenchThreads = 4000;
+static const int BenchRemovals = 1000000;
+
+void
+ReadyQueueBenchmark()
+{
+    Thread **threads = new Thread*[BenchThreads];
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    clock_t start = clock();
+    double seconds;
+    int i, victim;
+
+    for (i = 0; i < BenchThreads; i++) {
+	threads[i] = new Thread("bench");
+	scheduler->ReadyToRun(threads[i]);
+    }
+    for (i = 0; i < BenchRemovals; i++) {
+	victim = Random() % BenchThreads;
+	ASSERT(scheduler->RemoveThisThread(threads[victim]));
+	ASSERT(!scheduler->RemoveThisThread(threads[victim]));
+	scheduler->ReadyToRun(threads[victim]);
+    }
+    for (i = 0; i < BenchThreads; i++) {
+	ASSERT(scheduler->RemoveThisThread(threads[i]));
+	delete threads[i];
+    }
+    delete [] threads;
+    (void) interrupt->SetLevel(oldLevel);
+
+    seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    printf("Ready queue: %d removals from %d ready threads, %.2f seconds",
+	BenchRemovals, BenchThreads, seconds);
+    if (seconds > 0)
+	printf(" (%.0f per second)", BenchRemovals / seconds);
+    printf("\n");
+}
+
+//----------------------------------------------------------------------
+// ForkExitBenchmark
+// 	Create threads that finish at once, in batches, as a Fork-heavy
+//	workload does, and report the host memory calls (mmap, mprotect,
+//	munmap) made per thread for their stacks.  Compare the stack
+//	pool, "nachos -q 5", with no pool, "nachos -q 5 -sc 0"; "-sw 8"
+//	also fills the pool at boot.
+//----------------------------------------------------------------------
+
+static const int ForkBatch = 8;
+static const int ForkRounds = 1000;
+
+static int forksDone;
+
+static void
+EmptyThread(int which)
+{
+    forksDone++;
+}
+
+void
+ForkExitBenchmark()
+{
+    int calls = stats->numHostMemoryCalls;
+    clock_t start = clock();
+    int i, j, n = ForkBatch * ForkRounds;
+
+    for (i = 0; i < ForkRounds; i++) {
+	for (j = 0; j < ForkBatch; j++) {
+	    Thread *t = new Thread("forker");
+	    t->Fork(EmptyThread, j);
+	}
+	while (forksDone < (i + 1) * ForkBatch)
+	    currentThread->Yield();		// until the batch has finished
+    }
+    calls = stats->numHostMemoryCalls - calls;
+    printf("Fork/exit: %d threads, %d host memory calls (%.2f per thread), "
+	"%.2f seconds\n", n, calls, (double) calls / n,
+	(double) (clock() - start) / CLOCKS_PER_SEC);
+}
+
 //----------------------------------------------------------------------
 // ThreadTest
 // 	Invoke a test routine.
@@ -64,6 +249,18 @@ ThreadTest()
     case 1:
 	ThreadTest1();
 	break;
+    case 2:
+	EventQueueBenchmark();
+	break;
+    case 3:
+	SleepTest();
+	break;
+    case 4:
+	ReadyQueueBenchmark();
+	break;
+    case 5:
+	ForkExitBenchmark();
+	break;
     default:
 	printf("No test specified.\n");
 	break;
@@ -18,12 +18,13 @@
 #include "copyright.h"
 #include "system.h"
 #include "addrspace.h"
-#include "noff.h"
 
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
 
+extern void exitProcess(int exVal);
+
 //----------------------------------------------------------------------
 // SwapHeader
 // 	Do little endian to big endian conversion on the bytes in the 
@@ -46,6 +47,264 @@ SwapHeader (NoffHeader *noffH)
 	noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
 }
 
+ProgramImage *ProgramImage::openImages = NULL;
+int ProgramImage::uses = 0;
+int ProgramImage::idleCost = 0;
+int ProgramImage::cacheBudget = DefaultExecCachePages;
+
+//----------------------------------------------------------------------
+// ProgramImage::Open
+// 	Return the image of the program in "executable", with a reference
+//	held for the caller.  If some address space is running that file,
+//	or ran it recently enough that its image is still cached, that
+//	image is used, and "executable" is closed.
+//----------------------------------------------------------------------
+
+ProgramImage *
+ProgramImage::Open(OpenFile *executable)
+{
+    int device, identity;
+    ProgramImage *image;
+
+    executable->Identity(&device, &identity);
+    for (image = openImages; image != NULL; image = image->next)
+	if (image->device == device && image->identity == identity) {
+	    delete executable;
+	    if (image->refs == 0) {	// it was idle, in the cache
+		idleCost -= image->Cost();
+		stats->numExecCacheHits++;
+	    }
+	    image->Hold();
+	    return image;
+	}
+    stats->numExecCacheMisses++;
+    image = new ProgramImage(executable);
+    image->next = openImages;
+    openImages = image;
+    return image;
+}
+
+//----------------------------------------------------------------------
+// ProgramImage::ProgramImage
+// 	Read the NOFF header of "executable", which from now on belongs
+//	to the image (it is closed when the last user releases it).
+//----------------------------------------------------------------------
+
+ProgramImage::ProgramImage(OpenFile *executable)
+{
+    file = executable;
+    file->Identity(&device, &identity);
+    refs = 1;
+    file->ReadAt((char *)&noffH, sizeof(noffH), 0);
+    if ((noffH.noffMagic != NOFFMAGIC) && 
+		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
+    	SwapHeader(&noffH);
+    ASSERT(noffH.noffMagic == NOFFMAGIC);
+
+    // coff2noff puts the initialized data right after the code, both
+    // in memory and in the file; then a page holding the end of one and
+    // the start of the other can be read in one go
+    loadable[0] = noffH.code;
+    loadable[1] = noffH.initData;
+    numLoadable = 2;
+    if (noffH.code.virtualAddr + noffH.code.size == noffH.initData.virtualAddr
+	  && noffH.code.inFileAddr + noffH.code.size == noffH.initData.inFileAddr) {
+	loadable[0].size += noffH.initData.size;
+	numLoadable = 1;
+    }
+
+    firstText = divRoundUp(noffH.code.virtualAddr, PageSize);
+    numText = divRoundDown(noffH.code.virtualAddr + noffH.code.size, PageSize)
+			- firstText;
+    if (numText < 0)
+	numText = 0;
+    textFrames = new int[numText];
+    for (int i = 0; i < numText; i++)
+	textFrames[i] = -1;
+    numTextLoaded = 0;
+}
+
+ProgramImage::~ProgramImage()
+{
+    ProgramImage **link;
+
+    ASSERT(refs == 0);
+    for (link = &openImages; *link != this; link = &(*link)->next)
+	ASSERT(*link != NULL);
+    *link = next;
+    for (int i = 0; i < numText; i++)
+	if (textFrames[i] != -1)
+	    mans_man->deallocate(textFrames[i]);
+    delete [] textFrames;
+    delete file;
+}
+
+void
+ProgramImage::Hold()
+{
+    refs++;
+}
+
+//----------------------------------------------------------------------
+// ProgramImage::Release
+// 	Drop a reference.  On the last, the image goes idle in the cache,
+//	which may push older idle images out -- unless its file has been
+//	removed, in which case nobody can run it again.
+//----------------------------------------------------------------------
+
+void
+ProgramImage::Release()
+{
+    ASSERT(refs > 0);
+    if (--refs > 0)
+	return;
+    if (identity == -1) {		// its file was removed
+	delete this;
+	return;
+    }
+    lastUsed = ++uses;
+    idleCost += Cost();
+    TrimCache();
+}
+
+int
+ProgramImage::Cost()
+{
+    return 1 + numTextLoaded;
+}
+
+void
+ProgramImage::SetCacheBudget(int pages)
+{
+    ASSERT(pages >= 0);
+    cacheBudget = pages;
+}
+
+void
+ProgramImage::TrimCache()
+{
+    while (idleCost > cacheBudget && DropIdle())
+	;
+}
+
+//----------------------------------------------------------------------
+// ProgramImage::DropIdle
+// 	Delete the idle image that went idle longest ago, closing its file
+//	and freeing its text pages.  Called when the cache is over budget,
+//	and when memory runs out.
+//----------------------------------------------------------------------
+
+bool
+ProgramImage::DropIdle()
+{
+    ProgramImage *image, *victim = NULL;
+
+    for (image = openImages; image != NULL; image = image->next)
+	if (image->refs == 0
+		&& (victim == NULL || image->lastUsed < victim->lastUsed))
+	    victim = image;
+    if (victim == NULL)
+	return FALSE;
+    DEBUG('a', "Dropping cached image of file %d\n", victim->identity);
+    idleCost -= victim->Cost();
+    stats->numExecCacheEvictions++;
+    delete victim;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// ProgramImage::Forget
+// 	The file "id" on "device" was removed, so its number may soon
+//	name a different file.  Throw away its image if idle; if some
+//	address space is still running it, just make sure Open never
+//	hands that image out again.
+//----------------------------------------------------------------------
+
+void
+ProgramImage::Forget(int device, int id)
+{
+    ProgramImage *image;
+
+    for (image = openImages; image != NULL; image = image->next)
+	if (image->device == device && image->identity == id)
+	    break;
+    if (image == NULL)
+	return;
+    DEBUG('a', "Forgetting image of removed file %d\n", id);
+    if (image->refs > 0) {
+	image->identity = -1;		// matches no file
+	return;
+    }
+    idleCost -= image->Cost();
+    delete image;
+}
+
+bool
+ProgramImage::IsText(int vpn)
+{
+    return vpn >= firstText && vpn < firstText + numText;
+}
+
+int
+ProgramImage::TextFrame(int vpn)
+{
+    ASSERT(IsText(vpn));
+    return textFrames[vpn - firstText];
+}
+
+void
+ProgramImage::SetTextFrame(int vpn, int frame)
+{
+    ASSERT(IsText(vpn) && textFrames[vpn - firstText] == -1);
+    textFrames[vpn - firstText] = frame;
+    numTextLoaded++;
+}
+
+int
+ProgramImage::Size()
+{
+    return noffH.code.size + noffH.initData.size + noffH.uninitData.size;
+}
+
+//----------------------------------------------------------------------
+// ProgramImage::LoadPage
+// 	Fill physical page "frame" with the initial contents of virtual
+//	page "vpn": whatever parts of the code and initialized data
+//	segments fall in the page are read from the file, and the rest
+//	(bss, stack, or the tail of the last segment page) is zeroed.
+//----------------------------------------------------------------------
+
+void
+ProgramImage::LoadPage(int vpn, int frame)
+{
+    char *dest = &(machine->mainMemory[frame * PageSize]);
+    int pageStart = vpn * PageSize;
+
+    bzero(dest, PageSize);
+    for (int i = 0; i < numLoadable; i++)
+	LoadSegment(&loadable[i], pageStart, dest);
+}
+
+//----------------------------------------------------------------------
+// ProgramImage::LoadSegment
+// 	Copy the part of segment "seg" that overlaps the page starting at
+//	virtual address "pageStart" into "dest", with a single read.
+//----------------------------------------------------------------------
+
+void
+ProgramImage::LoadSegment(Segment *seg, int pageStart, char *dest)
+{
+    int start = max(seg->virtualAddr, pageStart);
+    int end = min(seg->virtualAddr + seg->size, pageStart + PageSize);
+
+    if (start >= end)
+	return;
+    DEBUG('a', "Loading 0x%x..0x%x from file offset %d\n", start, end,
+			seg->inFileAddr + (start - seg->virtualAddr));
+    file->ReadAt(dest + (start - pageStart), end - start,
+			seg->inFileAddr + (start - seg->virtualAddr));
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
@@ -70,111 +329,298 @@ AddrSpace::AddrSpace()
     pcbMan->assignPCB(thisPCB);
     numPages=0;
     pageIndex=0;
+    pageTable = NULL;
+    image = NULL;
+#ifdef VM
+    swapSlot = NULL;
+#endif
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::MapVPN2PPN
+// 	Build a page table for "numPages" pages, none of them in memory
+//	yet: each page is read in from "image" (or zero-filled) the first
+//	time it is touched, by pageFault.
+//----------------------------------------------------------------------
+
 void
 AddrSpace::MapVPN2PPN(int numPages, int size) {
     DEBUG('a', "Initializing address space, num pages %d, size %d\n", 
 					numPages, size);
-    memLock->Acquire();
     pageTable = new TranslationEntry[numPages];
     pageIndex = numPages;
     for (int i = 0; i < numPages; i++) 
     {
 	pageTable[i].virtualPage = i;
-	pageTable[i].physicalPage = mans_man->allocate();
-	pageTable[i].valid = true;
+	pageTable[i].physicalPage = -1;
+	pageTable[i].valid = false;
 	pageTable[i].use = false;
 	pageTable[i].dirty = false;
 	pageTable[i].readOnly = false; 
-    	bzero(machine->mainMemory + (pageTable[i].physicalPage * 128), PageSize);
+	pageTable[i].copyOnWrite = false;
     }
+#ifdef VM
+    swapSlot = new int[numPages];
+    for (int i = 0; i < numPages; i++)
+	swapSlot[i] = -1;
+#endif
 }
 
 AddrSpace::AddrSpace(OpenFile *executable)
 {
-    
-    NoffHeader noffH;
-    unsigned int i, size;
+    unsigned int size;
     worked = true;
 
     thisPCB = new pcb(currentThread);
     thisPCB->setAddrSpace(this);
     this->setPCB(thisPCB);
     pcbMan->assignPCB(thisPCB);
-    worked=true;
 
-    int counter=0;
     pageIndex = 0;
-    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
-    if ((noffH.noffMagic != NOFFMAGIC) && 
-		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
-    	SwapHeader(&noffH);
-    ASSERT(noffH.noffMagic == NOFFMAGIC);
+    image = ProgramImage::Open(executable);
 
 // how big is address space?
-    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
-			+ UserStackSize;	// we need to increase the size
+    size = image->Size() + UserStackSize;	// we need to increase the size
 						// to leave room for the stack
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
 
-    printf("Loaded Program: [%d] code | [%d] data | [%d] bss\n", noffH.code.size, noffH.initData.size, noffH.uninitData.size);
+    DEBUG('S', "Loaded Program: [%d] code | [%d] data | [%d] bss\n", image->noffH.code.size, image->noffH.initData.size, image->noffH.uninitData.size);
 
+    MapVPN2PPN(numPages, size);
+}
 
-    //test that there are enough pages left for this process
-    if(numPages > (unsigned) mans_man->getPages())
-    {
-        printf("Not Enough Memory for Process %d\n", this->getPID());
-	worked = false;
-	return;
-    }
-    
-    // Copy the code section into memory
-    int counter = 0;
-    if (noffH.code.size > 0) 
-    {
-        DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", 
-			noffH.code.virtualAddr, noffH.code.size);
 
-	while( counter < noffH.code.size)
-	{
-	    
-        	executable->ReadAt(&(machine->mainMemory[myTranslate(noffH.code.virtualAddr+counter)]),
-				1, noffH.code.inFileAddr+counter);
-		counter++;
-        }
-    }
+//----------------------------------------------------------------------
+// AddrSpace::~AddrSpace
+// 	Dealloate an address space, giving back any pages still in memory.
+//	The pcb goes too, unless it has been detached with setPCB(NULL):
+//	an exited process's pcb outlives its memory until it is Joined.
+//----------------------------------------------------------------------
 
-    // Copy the initialized data section
-    counter = 0;
-    if (noffH.initData.size > 0) 
-    {
-        DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", 
-			noffH.initData.virtualAddr, noffH.initData.size);
-	while( counter < noffH.initData.size)
-	{
+AddrSpace::~AddrSpace()
+{
+   delete thisPCB;
+   if (pageTable != NULL) {
+	freeFrames();
+	delete [] pageTable;
+#ifdef VM
+	delete [] swapSlot;
+#endif
+   }
+   if (image != NULL)
+	image->Release();
+}
 
-        	executable->ReadAt(&(machine->mainMemory[myTranslate(noffH.initData.virtualAddr+counter)]),
-				1, noffH.initData.inFileAddr+counter);
+//----------------------------------------------------------------------
+// AddrSpace::freeFrames
+// 	Give back the frames of every resident page (and, with virtual
+//	memory, the swap slots of every paged-out one).  Pages that were
+//	never touched have nothing to give back.
+//
+//	Takes the paging lock, so that it can't pull a page out from
+//	under the pageout daemon while it is being written to swap.
+//----------------------------------------------------------------------
 
-		counter++;
+void
+AddrSpace::freeFrames()
+{
+    bool locked = !pagingLock->isHeldByCurrentThread();
+
+    if (locked)
+	pagingLock->Acquire();
+    for (unsigned int i = 0; i < numPages; i++) {
+	if (pageTable[i].valid) {
+#ifdef VM
+	    coreMap->Unmap(pageTable[i].physicalPage, this);
+#endif
+	    mans_man->deallocate(pageTable[i].physicalPage);
+	    pageTable[i].valid = FALSE;
+	}
+#ifdef VM
+	if (swapSlot[i] != -1) {
+	    swapSpace->Free(swapSlot[i]);
+	    swapSlot[i] = -1;
 	}
+#endif
     }
+    if (locked)
+	pagingLock->Release();
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::getFrame
+// 	Take a free frame.  If none is free, idle cached program images
+//	give up their text pages; after that, with virtual memory, some
+//	page (maybe one of ours) is paged out to make one.  The caller
+//	holds the paging lock.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::getFrame()
+{
+    int frame = mans_man->allocate();
+
+    ASSERT(pagingLock->isHeldByCurrentThread());
+
+    while (frame == -1 && ProgramImage::DropIdle())
+	frame = mans_man->allocate();
 
-    memLock->Release();
+#ifdef VM
+    while (frame == -1 && coreMap->MakeRoom())
+	frame = mans_man->allocate();
+    pageoutDaemon->Check();
+#endif
+    return frame;
 }
 
+#ifdef VM
+//----------------------------------------------------------------------
+// AddrSpace::evictPage
+// 	Page out page "vpn", which must be resident and not shared, and
+//	give its frame back.  The page is only written to swap if it has
+//	changed since it was last read in; otherwise the copy in swap, or
+//	in the executable, is still good.
+//
+//	Returns FALSE, leaving the page resident, if it needs writing and
+//	swap is full.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::evictPage(int vpn)
+{
+    TranslationEntry *entry = &pageTable[vpn];
+    int frame = entry->physicalPage;
+
+    ASSERT(entry->valid && mans_man->refs(frame) == 1);
+#ifdef USE_TLB
+    if (currentThread->space == this)
+	syncTLB(vpn);			// the TLB may have the dirty bit
+#endif
+    if (entry->dirty && swapSlot[vpn] == -1) {
+	swapSlot[vpn] = swapSpace->Allocate();
+	if (swapSlot[vpn] == -1)
+	    return FALSE;
+    }
+    entry->valid = FALSE;		// before the write, which may block
+    if (entry->dirty)
+	swapSpace->WritePage(swapSlot[vpn], frame);
+    entry->dirty = FALSE;
+    if (entry->copyOnWrite) {		// we were the last to share it
+	entry->readOnly = FALSE;
+	entry->copyOnWrite = FALSE;
+    }
+    if (currentThread->space == this)
+	machine->FlushHostTLB();
+    coreMap->Unmap(frame, this);
+    mans_man->deallocate(frame);
+    return TRUE;
+}
 
 //----------------------------------------------------------------------
-// AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// AddrSpace::cleanPage
+// 	The pageout daemon is about to write resident, dirty page "vpn"
+//	to swap: make sure it has a slot, and mark it clean.  If the page
+//	is written again meanwhile, Translate just marks it dirty again.
+//
+//	Returns the slot, or -1 if swap is full.
 //----------------------------------------------------------------------
 
-AddrSpace::~AddrSpace()
+int
+AddrSpace::cleanPage(int vpn)
 {
-   delete thisPCB;
-   delete pageTable;
+    TranslationEntry *entry = &pageTable[vpn];
+
+    ASSERT(entry->valid && entry->dirty);
+    if (swapSlot[vpn] == -1)
+	swapSlot[vpn] = swapSpace->Allocate();
+    if (swapSlot[vpn] != -1) {
+	entry->dirty = FALSE;
+	// a cached translation would let stores skip setting it again;
+	// other spaces' are flushed by RestoreState when they next run
+	if (currentThread->space == this)
+	    machine->FlushHostTLB();
+    }
+    return swapSlot[vpn];
+}
+#endif
+
+//----------------------------------------------------------------------
+// AddrSpace::pageFault
+// 	Make virtual page "vpn" resident: on its first touch, take a free
+//	frame and load it from the executable (see ProgramImage::LoadPage).
+//	Text pages are mapped read-only, and if another address space
+//	running the same program has already loaded one, its frame is
+//	shared instead.  With a software TLB, a fault may also just be a
+//	TLB miss, so the entry is then loaded into the TLB as well.
+//
+//	Returns FALSE if "vpn" is outside the address space, or if there
+//	is no free frame.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::pageFault(int vpn)
+{
+    TranslationEntry *entry;
+    int frame;
+    bool text;
+
+    if (vpn < 0 || (unsigned) vpn >= numPages)
+	return FALSE;
+    entry = &pageTable[vpn];
+    if (!entry->valid) {
+	text = image->IsText(vpn);
+	frame = text ? image->TextFrame(vpn) : -1;
+	if (frame != -1) {
+	    DEBUG('a', "Page fault: sharing text page %d in frame %d\n",
+			vpn, frame);
+	    stats->numTextPagesShared++;
+	} else {
+	    frame = getFrame();
+	    if (frame == -1) {
+		printf("Not Enough Memory for Process %d\n", this->getPID());
+		return FALSE;
+	    }
+	    DEBUG('a', "Page fault: loading page %d into frame %d\n",
+			vpn, frame);
+#ifdef VM
+	    if (swapSlot[vpn] != -1)
+		swapSpace->ReadPage(swapSlot[vpn], frame);
+	    else
+#endif
+	    image->LoadPage(vpn, frame);
+	    if (text) {			// the image's reference
+		image->SetTextFrame(vpn, frame);
+		stats->numTextPagesLoaded++;
+	    }
+	}
+	if (text)			// and ours
+	    mans_man->share(frame);
+	entry->virtualPage = vpn;
+	entry->physicalPage = frame;
+	entry->valid = TRUE;
+	entry->use = FALSE;
+	entry->dirty = FALSE;
+	entry->readOnly = text;
+	entry->copyOnWrite = FALSE;
+	stats->numPageFaults++;
+#ifdef VM
+	coreMap->Map(frame, this, vpn);
+#endif
+    }
+#ifdef USE_TLB
+    static int tlbNext = 0;		// round-robin TLB replacement
+    TranslationEntry *slot = &(machine->tlb[tlbNext]);
+
+    tlbNext = (tlbNext + 1) % TLBSize;
+    if (slot->valid) {			// keep what the TLB learned
+	pageTable[slot->virtualPage].use |= slot->use;
+	pageTable[slot->virtualPage].dirty |= slot->dirty;
+    }
+    *slot = *entry;
+    machine->FlushHostTLB();		// the evicted entry may be cached
+#endif
+    return TRUE;
 }
 
 //----------------------------------------------------------------------
@@ -214,13 +660,41 @@ AddrSpace::InitRegisters()
 // 	On a context switch, save any machine state, specific
 //	to this address space, that needs saving.
 //
-//	For now, nothing!
+//	With a software TLB, that is the use and dirty bits it holds.
 //----------------------------------------------------------------------
 
 void AddrSpace::SaveState() 
 {
+#ifdef USE_TLB
+    syncTLB(-1);
+#endif
 }
 
+#ifdef USE_TLB
+//----------------------------------------------------------------------
+// AddrSpace::syncTLB
+// 	Copy the use and dirty bits of the TLB entries for page "vpn"
+//	(or for every page, if "vpn" is -1) back into the page table, and
+//	drop those entries, so that the next access reloads them from
+//	the page table.
+//----------------------------------------------------------------------
+
+void AddrSpace::syncTLB(int vpn)
+{
+    TranslationEntry *slot;
+
+    for (int i = 0; i < TLBSize; i++) {
+	slot = &(machine->tlb[i]);
+	if (!slot->valid || (vpn != -1 && slot->virtualPage != vpn))
+	    continue;
+	pageTable[slot->virtualPage].use |= slot->use;
+	pageTable[slot->virtualPage].dirty |= slot->dirty;
+	slot->valid = FALSE;
+    }
+    machine->FlushHostTLB();
+}
+#endif
+
 void AddrSpace::SaveReg()
 {
     int i;
@@ -240,8 +714,14 @@ void AddrSpace::SaveReg()
 
 void AddrSpace::RestoreState() 
 {
+#ifdef USE_TLB
+    for (int i = 0; i < TLBSize; i++)	// entries were for the old space
+	machine->tlb[i].valid = FALSE;
+#else
     machine->pageTable = pageTable;
     machine->pageTableSize = numPages;
+#endif
+    machine->FlushHostTLB();	// cached translations were for the old table
     pageIndex = numPages;
 }
 
@@ -261,6 +741,21 @@ unsigned int AddrSpace:: myTranslate(int virtAddr)
 
     virPage = virtAddr/PageSize;
     offset = virtAddr % PageSize;
+    if ((unsigned) virPage >= numPages || !pageTable[virPage].valid)
+    {
+	// not touched by the program yet, so bring it in for the kernel
+	bool loaded;
+
+	pagingLock->Acquire();
+	loaded = pageFault(virPage);
+	pagingLock->Release();
+	if (!loaded)
+	{
+	    printf("Process [%d] cannot access address [0x%x]\n",
+		    this->getPID(), virtAddr);
+	    exitProcess(-1);
+	}
+    }
     phyAddr = (pageTable[virPage].physicalPage * PageSize) + offset;
     return phyAddr;
 }
@@ -300,40 +795,126 @@ void AddrSpace:: setWorked(bool input)
     worked = input;
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::copyMemory
+// 	Give the child address space "input" a copy of this one, for Fork.
+//	Nothing is copied yet: the child maps the same frames, and every
+//	writable page is marked readOnly and copyOnWrite in both page
+//	tables, so the first write by either process copies just that page
+//	(see copyOnWriteFault).  The cost of Fork is thus proportional to
+//	the pages written afterwards, which for Fork-then-Exec is none.
+//----------------------------------------------------------------------
+
 void AddrSpace::copyMemory(AddrSpace *input)
 {
-
-    //copy allocate and copy memory
     int currentPages = this->numPages;
     int i;
-//printf("Child Process %d, currentPages: %d, remainingPages: %d\n", input->getPID(),currentPages, mans_man->getPages());
-    if( currentPages > mans_man->getPages())
-    {
-	printf("Not Enough Memory for Child Process %d\n", input->getPID());
-	input->setWorked(false);
-	return;
-    }
 
     input->numPages=this->numPages;
+    input->image = image;		// for pages neither of us has touched
+    image->Hold();
+#ifdef USE_TLB
+    syncTLB(-1);			// our entries are about to change
+#endif
     
     input->pageTable = new TranslationEntry[currentPages];
+#ifdef VM
+    input->swapSlot = new int[currentPages];
+#endif
     for (i = 0; i < currentPages; i++) 
     {
-	input->pageTable[i].virtualPage = i;
-	input->pageTable[i].physicalPage = mans_man->allocate();
-	input->pageTable[i].valid = TRUE;
+#ifdef VM
+	input->swapSlot[i] = -1;
+#endif
+	if (!pageTable[i].valid)
+	{
+	    input->pageTable[i] = pageTable[i];
+#ifdef VM
+	    // paged out: the child needs its own copy in swap
+	    if (swapSlot[i] != -1) {
+		input->swapSlot[i] = swapSpace->Copy(swapSlot[i]);
+		if (input->swapSlot[i] == -1)
+		    input->worked = false;
+	    }
+#endif
+	    continue;
+	}
+	if (!pageTable[i].readOnly)
+	{
+	    pageTable[i].readOnly = TRUE;
+	    pageTable[i].copyOnWrite = TRUE;
+	}
+	input->pageTable[i] = pageTable[i];
 	input->pageTable[i].use = FALSE;
+#ifdef VM
+	// the child has no copy in swap, so unless the page is still
+	// what the executable says, it must be written out on page-out
+	input->pageTable[i].dirty = pageTable[i].dirty || swapSlot[i] != -1;
+	coreMap->Map(pageTable[i].physicalPage, input, i);
+#else
 	input->pageTable[i].dirty = FALSE;
-	input->pageTable[i].readOnly = FALSE; 
-    	//bzero(machine->mainMemory[this->pageTable[i].physicalPage * 128], PageSize);
-	bcopy(&(machine->mainMemory[this->pageTable[i].physicalPage*128]),&(machine->mainMemory[input->pageTable[i].physicalPage*128]), 128); 
+#endif
+	mans_man->share(pageTable[i].physicalPage);
     }
+    machine->FlushHostTLB();	// our own pages just became read-only
 
     //set PCBs 
     (input->getPCB())->setParent((this->getPCB()));
     (this->getPCB())->addChild((input->getPCB()));
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::copyOnWriteFault
+// 	Handle a write to page "vpn" that raised a ReadOnlyException.  If
+//	the page is copy-on-write, give this address space its own copy of
+//	the frame (or, if nobody else shares the frame any more, just take
+//	it over) and make the page writable again, so that the write can
+//	be restarted.
+//
+//	Returns FALSE if the page is really read-only, or if there is no
+//	free frame for the copy.
+//----------------------------------------------------------------------
+
+bool AddrSpace::copyOnWriteFault(int vpn)
+{
+    TranslationEntry *entry;
+    int oldFrame, newFrame;
+
+    if (vpn < 0 || (unsigned) vpn >= numPages)
+	return FALSE;
+#ifdef USE_TLB
+    syncTLB(vpn);			// the write retries through the table
+#endif
+    entry = &pageTable[vpn];
+    if (!entry->valid || !entry->copyOnWrite)
+	return FALSE;
+
+    oldFrame = entry->physicalPage;
+    if (mans_man->refs(oldFrame) > 1)
+    {
+	newFrame = getFrame();
+	if (newFrame == -1)
+	{
+	    printf("Not Enough Memory for Process %d\n", this->getPID());
+	    return FALSE;
+	}
+	bcopy(&(machine->mainMemory[oldFrame * PageSize]),
+		&(machine->mainMemory[newFrame * PageSize]), PageSize);
+	mans_man->deallocate(oldFrame);
+#ifdef VM
+	coreMap->Unmap(oldFrame, this);
+	coreMap->Map(newFrame, this, vpn);
+#endif
+	entry->physicalPage = newFrame;
+	stats->numPagesCopied++;
+    }
+    entry->readOnly = FALSE;
+    entry->copyOnWrite = FALSE;
+    stats->numCopyOnWriteFaults++;
+    machine->FlushHostTLB();	// the entry changed under the cache
+    return TRUE;
+}
+
 void AddrSpace:: getString(char * str, int virtAd)
 {
     int i=0;
@@ -354,106 +935,39 @@ void AddrSpace:: getString(char * str, int virtAd)
     }
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::execThread
+// 	Replace this address space's program with the one in "executable".
+//	The old pages are given back, and the new program is paged in on
+//	demand, like at startup.
+//----------------------------------------------------------------------
+
 void AddrSpace:: execThread(OpenFile *executable)
 {
-    NoffHeader noffH;
-    int oldPages = numPages;
-    unsigned int i, size;
+    ProgramImage *newImage = ProgramImage::Open(executable);
+    unsigned int size;
     worked = true;
 
-    worked=true;
-
-    int counter=0;
-
-    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
-    if ((noffH.noffMagic != NOFFMAGIC) && 
-		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
-    	SwapHeader(&noffH);
-    ASSERT(noffH.noffMagic == NOFFMAGIC);
-
 // how big is address space?
-    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
-			+ UserStackSize;	// we need to increase the size
+    size = newImage->Size() + UserStackSize;	// we need to increase the size
 						// to leave room for the stack
-    numPages = divRoundUp(size, PageSize);
-    size = numPages * PageSize;
-
-    printf("Loaded Program: [%d] code | [%d] data | [%d] bss\n", noffH.code.size, noffH.initData.size, noffH.uninitData.size);
-
 
-
-    //test that there are enough pages left for this process
-    if(numPages > ((unsigned) mans_man->getPages() + oldPages))
-    {
-	printf("Not Enough Memory for Process %d\n", this->getPID());
-	worked = false;
-	numPages = oldPages;
-	size = numPages * PageSize;
-    pageIndex = 0;
-	return;
-    }
+    DEBUG('S', "Loaded Program: [%d] code | [%d] data | [%d] bss\n", newImage->noffH.code.size, newImage->noffH.initData.size, newImage->noffH.uninitData.size);
 
     //delete current pageTable and remove pages from memory
-    for(i=0; i < oldPages; i++)
-    {
-	mans_man->deallocate(pageTable[i].physicalPage);
-    }
-    delete pageTable;
-
-
-    DEBUG('a', "Initializing address space, num pages %d, size %d\n", 
-					numPages, size);
-
-    memLock->Acquire();
-
-    pageTable = new TranslationEntry[numPages];
-    for (i = 0; i < numPages; i++) 
-    {
-	pageTable[i].virtualPage = i;
-	pageTable[i].physicalPage = mans_man->allocate();
-	pageTable[i].valid = TRUE;
-	pageTable[i].use = FALSE;
-	pageTable[i].dirty = FALSE;
-	pageTable[i].readOnly = FALSE; 
-    	//bzero(machine->mainMemory + (pageTable[i].physicalPage * 128), PageSize);
-    }
-
-    // Copy the code section into memory
-    counter = 0;
-    if (noffH.code.size > 0) 
-    {
-        DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", 
-			noffH.code.virtualAddr, noffH.code.size);
-
-	while( counter < noffH.code.size)
-	{
-	    
-        	executable->ReadAt(&(machine->mainMemory[myTranslate(noffH.code.virtualAddr+counter)]),
-				1, noffH.code.inFileAddr+counter);
-		counter++;
-        }
-    }
-
-    // Copy the initialized data section
-    counter = 0;
-    if (noffH.initData.size > 0) 
-    {
-        DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", 
-			noffH.initData.virtualAddr, noffH.initData.size);
-	while( counter < noffH.initData.size)
-	{
-
-        	executable->ReadAt(&(machine->mainMemory[myTranslate(noffH.initData.virtualAddr+counter)]),
-				1, noffH.initData.inFileAddr+counter);
+    freeFrames();
+    delete [] pageTable;
+#ifdef VM
+    delete [] swapSlot;
+#endif
+    image->Release();
+    image = newImage;
 
-		counter++;
-	}
-    }
+    numPages = divRoundUp(size, PageSize);
+    size = numPages * PageSize;
+    MapVPN2PPN(numPages, size);
 
     //clear the registers and set machines pagetable to point to this new one
     InitRegisters();
     RestoreState();
-
-    memLock->Release();
-
 }
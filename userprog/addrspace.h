@@ -15,6 +15,7 @@
 
 #include "copyright.h"
 #include "filesys.h"
+#include "noff.h"
 
 #ifdef CHANGED
 #include "pcb.h"
@@ -23,6 +24,81 @@ class pcb;
 
 
 #define UserStackSize		1024 	// increase this as necessary!
+#define DefaultExecCachePages	16	// budget for idle program images
+
+// The executable file an address space is demand paged from.  Fork
+// shares it between parent and child, since pages neither has touched
+// yet still have to come from the file; the file is closed when the
+// last address space lets go of it.
+//
+// Every address space running the same file (same header sector, or
+// same host device and i-node with the stub file system) shares one
+// image, found with ProgramImage::Open.  Pages holding nothing but code are mapped
+// read-only, and the image remembers the frame each such text page was
+// loaded into, so the other address spaces can just map that frame.
+//
+// When the last address space lets go of an image, it is kept, idle,
+// in case the program is run again: then Exec skips parsing the header
+// and finds the text pages already in memory.  Idle images are thrown
+// away, least recently used first, when they would cost more than the
+// exec cache budget (a page for the image itself, plus its text pages),
+// or when memory runs out.
+
+class ProgramImage {
+  public:
+    static ProgramImage *Open(OpenFile *file);
+					// the image of "file"; takes
+					// ownership of "file"
+    ~ProgramImage();			// close the file, drop text pages
+
+    void Hold();			// one more address space uses us
+    void Release();			// one fewer; idle after the last
+
+    int Size();				// bytes of code, data and bss
+    void LoadPage(int vpn, int frame);	// fill "frame" with virtual page
+					// "vpn" of the program
+
+    bool IsText(int vpn);		// only code on page "vpn"?
+    int TextFrame(int vpn);		// frame holding text page "vpn",
+					// or -1 if not loaded yet
+    void SetTextFrame(int vpn, int frame);
+					// text page "vpn" was loaded into
+					// "frame"; the image keeps a
+					// reference to it
+
+    static void SetCacheBudget(int pages);
+					// most pages idle images may cost
+    static bool DropIdle();		// throw away the least recently
+					// used idle image; FALSE if none
+    static void Forget(int device, int id);
+					// file "id" was removed; don't
+					// reuse its image
+
+    NoffHeader noffH;			// the (byte-swapped) header
+
+  private:
+    ProgramImage(OpenFile *file);	// read the NOFF header
+    int Cost();				// pages this image holds on to
+    static void TrimCache();		// drop idle images over budget
+    void LoadSegment(Segment *seg, int pageStart, char *dest);
+
+    Segment loadable[2];		// parts of the file to load: code
+    int numLoadable;			// and data, or both as one piece
+    OpenFile *file;
+    int device, identity;		// file->Identity()
+    int refs;
+
+    int firstText, numText;		// pages with nothing but code
+    int *textFrames;			// frame of each, or -1
+    int numTextLoaded;			// how many have a frame
+
+    int lastUsed;			// "uses" when it last went idle
+    ProgramImage *next;			// on the list of images, in use
+    static ProgramImage *openImages;	// or idle
+    static int uses;
+    static int idleCost;		// pages held by idle images
+    static int cacheBudget;		// and the most they may hold
+};
 
 class AddrSpace {
   public:
@@ -44,7 +120,17 @@ class AddrSpace {
     int getPID();
     int getNumPages();
     TranslationEntry * getPageTable();
-    void AddrSpace::copyMemory(AddrSpace *input);
+    void copyMemory(AddrSpace *input);	// share our pages with a
+					// child, copy-on-write
+    bool copyOnWriteFault(int vpn);	// copy a shared page on its
+					// first write
+    bool pageFault(int vpn);		// bring page "vpn" into memory
+    void freeFrames();			// give back our resident pages
+#ifdef VM
+    bool evictPage(int vpn);		// page "vpn" out, freeing its frame
+    int cleanPage(int vpn);		// swap slot to write "vpn" to
+					// ahead of time, or -1
+#endif
     bool check();
     void setCheck();
     void setWorked(bool input);
@@ -54,6 +140,9 @@ class AddrSpace {
     void execThread(OpenFile * executable);
     unsigned int myTranslate(int virtAddr);
     void MapVPN2PPN(int, int);
+#ifdef USE_TLB
+    void syncTLB(int vpn);		// write back, drop TLB entries
+#endif
     
     char* name; //name of address space
     
@@ -64,6 +153,12 @@ class AddrSpace {
     unsigned int numPages;		// Number of pages in the virtual 
 					// address space
     int pageIndex;
+    ProgramImage *image;		// where non-resident pages come from
+#ifdef VM
+    int *swapSlot;			// swap slot holding each page, or -1
+#endif
+    int getFrame();			// a free frame, paging one out if
+					// need be; -1 if there is none
     pcb* thisPCB;
     int regArray[NumTotalRegs];
 };
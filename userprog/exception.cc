@@ -49,57 +49,114 @@
 //----------------------------------------------------------------------
 
 void updateCounter();
-void syscallYield();
-void syscallExit();
-int syscallJoin();
-int syscallFork();
-void helpFork(int i);
-int syscallKill();
-void syscallHalt();
-int syscallExec();
 void handlePageFaultException();
+void handleReadOnlyException();
+void exitProcess(int exVal);
+void helpFork(int i);
 
 #if defined(CHANGED)
 
+// A system call handler does the work of one system call, leaving its
+// result (if any) in "*result".  It returns TRUE if the caller should
+// get that result in r2 and carry on at the next instruction; FALSE if
+// there is no caller to return to: Halt, Exit, and an Exec that
+// replaced the program all leave the registers as they want them.
+
+typedef bool (*SyscallHandler)(int *result);
+
+#define NumSyscalls	15	// one more than the highest SC_ code
+
+static struct {
+    char *name;				// for the trace
+    SyscallHandler handler;		// NULL if not implemented
+} syscallTable[NumSyscalls];
+
+bool syscallHalt(int *result);
+bool syscallExit(int *result);
+bool syscallExec(int *result);
+bool syscallJoin(int *result);
+bool syscallFork(int *result);
+bool syscallYield(int *result);
+bool syscallKill(int *result);
+bool syscallJoinAny(int *result);
+bool syscallSleep(int *result);
+bool syscallSetTickets(int *result);
+
+//----------------------------------------------------------------------
+// RegisterSyscall
+// 	Install "handler" as system call "type".
+//----------------------------------------------------------------------
+
+static void
+RegisterSyscall(int type, char *name, SyscallHandler handler)
+{
+    ASSERT(type >= 0 && type < NumSyscalls && type < NumSyscallTypes);
+    syscallTable[type].name = name;
+    syscallTable[type].handler = handler;
+    stats->syscallNames[type] = name;
+}
+
+static void
+RegisterSyscalls()
+{
+    RegisterSyscall(SC_Halt, "Halt", syscallHalt);
+    RegisterSyscall(SC_Exit, "Exit", syscallExit);
+    RegisterSyscall(SC_Exec, "Exec", syscallExec);
+    RegisterSyscall(SC_Join, "Join", syscallJoin);
+    RegisterSyscall(SC_Fork, "Fork", syscallFork);
+    RegisterSyscall(SC_Yield, "Yield", syscallYield);
+    RegisterSyscall(SC_Kill, "Kill", syscallKill);
+    RegisterSyscall(SC_JoinAny, "JoinAny", syscallJoinAny);
+    RegisterSyscall(SC_Sleep, "Sleep", syscallSleep);
+    RegisterSyscall(SC_SetTickets, "SetTickets", syscallSetTickets);
+}
+
 void
 ExceptionHandler(ExceptionType which) {
+    static bool registered = FALSE;
     int type = machine->ReadRegister(2);
+    int result, start;
+    SyscallStats *mine;
 
-    if (which == PageFaultException) {
+    if (which == SyscallException) {
+        if (!registered) {
+            RegisterSyscalls();
+            registered = TRUE;
+        }
+        if (type >= 0 && type < NumSyscalls
+                && syscallTable[type].handler != NULL) {
+            DEBUG('S', "System Call: [%d] invoked %s.\n",
+                    currentThread->space->getPID(), syscallTable[type].name);
+            mine = currentThread->space->getPCB()->getSyscallStats();
+            stats->syscalls->Entered(type);
+            mine->Entered(type);
+            start = stats->totalTicks;
+
+            result = 0;
+            if ((*syscallTable[type].handler)(&result)) {
+                machine->WriteRegister(2, result);
+                updateCounter();
+            }
+
+            // an Exec that returns FALSE is still here, in the same pcb
+            stats->syscalls->Returned(type, stats->totalTicks - start);
+            mine->Returned(type, stats->totalTicks - start);
+            ExitIfKilled();
+            return;
+        }
+    } else if (which == PageFaultException) {
         DEBUG('D', "PageFaultException being handled\n");
         handlePageFaultException();
+        ExitIfKilled();
+        return;
+    } else if (which == ReadOnlyException) {
+        DEBUG('a', "ReadOnlyException being handled\n");
+        handleReadOnlyException();
+        ExitIfKilled();
+        return;
     }
-
-    if ((which == SyscallException) && (type == SC_Halt)) {
-        DEBUG('a', "Shutdown, initiated by user program.\n");
-        syscallHalt();
-    }
-    else if ((which == SyscallException) && (type == SC_Yield)) {
-        DEBUG('a', "Yield System Call.\n");
-        syscallYield();
-        updateCounter();
-    } else if ((which == SyscallException) && (type == SC_Exit)) {
-        DEBUG('a', "Exit System Call.\n");
-        syscallExit();
-    } else if ((which == SyscallException) && (type == SC_Fork)) {
-        DEBUG('a', "Fork System Call.\n");
-        syscallFork();
-        updateCounter();
-    } else if ((which == SyscallException) && (type == SC_Exec)) {
-        DEBUG('a', "Exec System Call.\n");
-        syscallExec();
-    } else if ((which == SyscallException) && (type == SC_Join)) {
-        DEBUG('a', "Join System Call.\n");
-        syscallJoin();
-        updateCounter();
-    } else if ((which == SyscallException) && (type == SC_Kill)) {
-        DEBUG('a', "Kill System Call.\n");
-        syscallKill();
-        updateCounter();
-    } else {
-        printf("Unexpected user mode exception %d %d\n", which, type);
-        ASSERT(FALSE);
-    }
+    printf("Unexpected user mode exception %d %d\n", which, type);
+    ASSERT(FALSE);
 }
 #else
 
@@ -121,19 +178,51 @@ ExceptionHandler(ExceptionType which) {
 #include "../machine/machine.h"
 
 extern Machine* machine;
-Lock* pagingLock;
 
 //#if defined(CHANGED)
 
+//----------------------------------------------------------------------
+// handlePageFaultException
+// 	A user access to a page that isn't in memory yet: load it, and
+//	let the instruction be retried (the PC is left alone).  If the
+//	address is outside the address space, or no frame is free, the
+//	process is killed.
+//----------------------------------------------------------------------
+
 void handlePageFaultException() {
-    if (pagingLock == NULL) {
-        pagingLock = new Lock("pageingLock");
+    bool loaded;
+    int badVirtualAddr = machine->ReadRegister(BadVAddrReg);
+    pagingLock->Acquire();
+    loaded = currentThread->space->pageFault(badVirtualAddr / PageSize);
+    pagingLock->Release();
+
+    if (!loaded) {
+        printf("Process [%d] cannot access address [0x%x]\n",
+                currentThread->space->getPID(), badVirtualAddr);
+        exitProcess(-1);
     }
+}
+
+//----------------------------------------------------------------------
+// handleReadOnlyException
+// 	A write to a read-only page: if the page is only read-only because
+//	it is shared copy-on-write, copy it and let the write be retried
+//	(the PC is left alone).  Otherwise the process is killed.
+//----------------------------------------------------------------------
 
+void handleReadOnlyException() {
     int badVirtualAddr = machine->ReadRegister(BadVAddrReg);
+    bool copied;
+
     pagingLock->Acquire();
-    currentThread->space->pageFault(vpn);
+    copied = currentThread->space->copyOnWriteFault(badVirtualAddr / PageSize);
     pagingLock->Release();
+
+    if (!copied) {
+        printf("Process [%d] cannot write to address [0x%x]\n",
+                currentThread->space->getPID(), badVirtualAddr);
+        exitProcess(-1);
+    }
 }
 
 void updateCounter() {
@@ -145,224 +234,265 @@ void updateCounter() {
     machine->WriteRegister(NextPCReg, counter + 4);
 }
 
-int syscallExec() {
-
-    printf("Syscall Call: [%d] invoked Exec.\n", currentThread->space->getPID());
+bool syscallExec(int *result) {
 
     //get the string an copy to memory of this addrspace
     int virtualAd = machine->ReadRegister(4);
-    char * fileName = new char[256];
+    char fileName[256];
     currentThread->space->getString(fileName, virtualAd);
 
 
     OpenFile *fileRead = fileSystem->Open(fileName);
     if (fileRead == NULL) {
         printf("Unable to open file %s\n", fileName);
-        updateCounter();
-        machine->WriteRegister(2, -1);
-        return -1;
+        *result = -1;
+        return TRUE;
     } else {
         currentThread->space->execThread(fileRead);
 
         if (currentThread->space->check() == false) {
-            updateCounter();
-            return -1;
+            *result = -1;
+            return TRUE;
         }
 
-        printf("Exec Program: [%d] loading [%s]\n", currentThread->space->getPID(), fileName);
-        machine->WriteRegister(2, 1);
-        return 1;
+        DEBUG('S', "Exec Program: [%d] loading [%s]\n", currentThread->space->getPID(), fileName);
+        return FALSE;			// the new program starts afresh
     }
 }
 
-void syscallHalt() {
-    printf("Syscall Call: [%d] invoked call Halt.\n", currentThread->space->getPID());
+bool syscallHalt(int *result) {
     interrupt->Halt();
+    return FALSE;
 }
 
-void syscallYield() {
-    printf("System Call: [%d] invoked Yield.\n", currentThread->space->getPID());
+bool syscallYield(int *result) {
     currentThread->Yield();
+    return TRUE;
 }
 
-int syscallKill() {
-    int i, killID, index;
-    pcb* killPCB;
-    printf("System Call: [%d] invoked Kill.\n", currentThread->space->getPID());
-
-
-    killID = machine->ReadRegister(4);
-
-    //if its not a valid ID, return error
-    if (!pcbMan->validPID(killID)) {
-        printf("Process [%d] cannot kill process [%d]: doesn't exist\n", currentThread->space->getPID(), killID);
-        machine->WriteRegister(2, -1);
-        return -1;
-    } else if (currentThread == (pcbMan->getThisPCB(killID))->returnThread()) {
-        syscallExit();
-        machine->WriteRegister(2, 0);
-        index = killID;
-        return 0;
-    } else {
+bool syscallSleep(int *result) {
+    alarmClock->Pause(machine->ReadRegister(4));
+    return TRUE;
+}
 
-        //get a pointer to the pcb of the process to be killed
-        killPCB = pcbMan->getThisPCB(killID);
-        index = killID;
+bool syscallSetTickets(int *result) {
+    int tickets = machine->ReadRegister(4);
 
-        //if this process has children, set their parent pointers to null
-        if (killPCB->numberChildren() > 0) {
-            killPCB->setParentsNull();
-        }
+    if (tickets < 1 || tickets > MaxTickets) {
+        *result = -1;
+        return TRUE;
+    }
+    scheduler->SetTickets(currentThread, tickets);
+    DEBUG('S', "Process [%d] now has [%d] tickets\n", currentThread->space->getPID(), tickets);
+    return TRUE;
+}
 
-        //if this process has a parent, remove itself from the childManager  
+//----------------------------------------------------------------------
+// retirePCB
+// 	Finish with the pcb of a process that has ended with "status",
+//	and is no longer attached to its address space.  If the parent is
+//	still around, the pcb is kept as a zombie for the parent to Join;
+//	otherwise nobody can ask for the status, so it goes now.
+//	A live parent also gets back the tickets it gave up at Fork (not
+//	however many the child has since given itself).
+//----------------------------------------------------------------------
 
-        if (killPCB->getParent() != NULL) {
-            killPCB->getParent()->removeChild(killID);
-        }
+static void retirePCB(pcb *p, int status) {
+    int id = p->getID();
 
-        //remove itself from the pcbManager and PID manager
-        pcbMan->removePCB(killID);
-        pid_manager->removePid(killID);
+    p->setParentsNull();
+    if (p->getParent() != NULL) {
+        Thread *parent = p->getParent()->returnThread();
+        int tickets = parent->tickets + p->getLentTickets();
 
-        //free up the memory
-        AddrSpace *tempAd = killPCB->getAddrSpace();
-        TranslationEntry *tempPage = tempAd->getPageTable();
-        for (i = 0; i < tempAd->getNumPages(); i++) {
-            mans_man->deallocate(tempPage[i].physicalPage);
-        }
+        scheduler->SetTickets(parent, min(tickets, MaxTickets));
+        p->setExited(status);
+    } else {
+        pcbMan->removePCB(id);
+        pid_manager->removePid(id);
+        delete p;
+    }
+}
 
-        //check open files and delete them 
+bool syscallKill(int *result) {
+    int killID;
+    pcb* killPCB;
 
-        //Remove Thread from Scheduler and delete it
-        Thread* killThread = killPCB->returnThread();
-        scheduler->RemoveThisThread(killThread);
-        index = 0;
-        delete tempAd;
+    killID = machine->ReadRegister(4);
+    killPCB = pcbMan->getThisPCB(killID);
 
-        printf("Process [%d] killed process [%d]\n", currentThread->space->getPID(), killID);
-        machine->WriteRegister(2, 0);
-        return 0;
+    //if its not a valid ID, return error
+    if (killPCB == NULL || killPCB->hasExited()) {
+        printf("Process [%d] cannot kill process [%d]: doesn't exist\n", currentThread->space->getPID(), killID);
+        *result = -1;
+        return TRUE;
+    } else if (currentThread == killPCB->returnThread()) {
+        exitProcess(killID);
+        return FALSE;
+    } else {
+        // The victim may be in the middle of kernel work -- a page
+        // fault, disk I/O, copying memory for Fork -- and hold locks
+        // that only it can release.  So it is just marked (and woken,
+        // if it is asleep), and exits by itself, in ExitIfKilled.
+        killPCB->requestKill();
+        alarmClock->Wake(killPCB->returnThread());
+        DEBUG('S', "Process [%d] killed process [%d]\n", currentThread->space->getPID(), killID);
+        *result = 0;
+        return TRUE;
     }
 
 }
 
-void syscallExit() {
+//----------------------------------------------------------------------
+// ExitIfKilled
+// 	If the current process has been killed, end it now.  Called on
+//	the way back to user code: from ExceptionHandler, from the timer
+//	when it switches back to a thread that was running user code, and
+//	when a forked process first starts.  By then the process holds no
+//	locks, and has nothing half done.
+//----------------------------------------------------------------------
 
-    int i, id, exVal, index;
-    printf("System Call: [%d] invoked Exit.\n", currentThread->space->getPID());
-    exVal = machine->ReadRegister(4);
+void ExitIfKilled() {
+    AddrSpace *space = currentThread->space;
 
-    //if this process has children, set their parent pointers to null
-    if (currentThread->space->getPCB()->numberChildren() > 0) {
-        currentThread->space->getPCB()->setParentsNull();
-        index = exVal;
-    }
+    if (space != NULL && space->getPCB() != NULL
+            && space->getPCB()->killRequested())
+        exitProcess(-1);
+}
 
-    //if this process has a parent, remove itself from the childManager and set exit value to parent 
-    id = currentThread->space->getPID();
+bool syscallExit(int *result) {
 
+    exitProcess(machine->ReadRegister(4));
+    return FALSE;
+}
 
-    if (currentThread->space->getPCB()->getParent() != NULL) {
-        currentThread->space->getPCB()->getParent()->removeChild(id);
-        currentThread->space->getPCB()->getParent()->setChildExitValue(exVal);
-        index = id;
-    }
+//----------------------------------------------------------------------
+// exitProcess
+// 	End the current process with exit value "exVal": leave the exit
+//	value for the parent (see retirePCB), release its memory, and
+//	finish its thread.  Used by Exit, and to kill a process that
+//	faults.
+//----------------------------------------------------------------------
 
-    //remove itself from the pcbManager and PID manager
-    pcbMan->removePCB(id);
-    pid_manager->removePid(id);
+void exitProcess(int exVal) {
 
     AddrSpace *tempAd = currentThread->space;
-    TranslationEntry *tempPage = tempAd->getPageTable();
-    for (i = 0; i < tempAd->getNumPages(); i++) {
-        mans_man->deallocate(tempPage[i].physicalPage);
-    }
+    pcb *me = tempAd->getPCB();
+    int id = me->getID();
+
+    tempAd->setPCB(NULL);
+    retirePCB(me, exVal);
+
+    tempAd->freeFrames();
 
-    printf("Process [%d] exits with [%d]\n", id, exVal);
+    DEBUG('S', "Process [%d] exits with [%d]\n", id, exVal);
 
     //if this is the last process, then just exit
     delete tempAd;
+    currentThread->space = NULL;	// nothing left to save on the switch
     currentThread->Finish();
 }
 
-int syscallJoin() {
-    int id;
-    int index;
-    printf("System Call: [%d] invoked Join.\n", currentThread->space->getPID());
+//----------------------------------------------------------------------
+// syscallJoin
+// 	Wait for child "id" to exit, and return its exit value (-1 if
+//	"id" is not a child of ours).  The caller sleeps until the child
+//	calls Exit or is killed, rather than polling.
+//----------------------------------------------------------------------
+
+bool syscallJoin(int *result) {
+    int id, status;
+    pcb *me = currentThread->space->getPCB();
+
     id = machine->ReadRegister(4);
 
-    if (currentThread->space->getPCB()->getParent() != NULL) {
-        if (currentThread->space->getPCB()->getParent()->getID() == id) {
-            machine->WriteRegister(2, -1);
-            return -1;
-        }
-    } else if (currentThread->space->getPCB()->checkForChild(id)) {
-        index = id;
-        while (currentThread->space->getPCB()->checkForChild(id)) {
-            currentThread->Yield();
-        }
-        machine->WriteRegister(2, currentThread->space->getPCB()->getChildExitValue());
-        return (currentThread->space->getPCB()->getChildExitValue());
-    } else {
-        machine->WriteRegister(2, -1);
+    *result = -1;
+    if (me->waitForChild(id, &status)) {
+        *result = status;
     }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// syscallJoinAny
+// 	Wait for any child to exit, and return its id (-1 if there are
+//	no children).  Join on that id then collects the exit value
+//	without waiting.
+//----------------------------------------------------------------------
 
-    return -1;
+bool syscallJoinAny(int *result) {
+    pcb *me = currentThread->space->getPCB();
 
+    *result = me->waitForAnyChild();
+    return TRUE;
 }
 
 void helpFork(int i) {
     currentThread->space->RestoreReg();
     currentThread->space->RestoreState();
+    ExitIfKilled();			// before it runs a single instruction
     machine->Run();
 }
 
-int syscallFork() {
+bool syscallFork(int *result) {
 
     unsigned int oldPC, oldPrevPC, oldNextPC;
-    unsigned int index;
     currentThread->space->SaveReg();
 
-    printf("System Call: [%d] invoked Fork.\n", currentThread->space->getPID());
-
     AddrSpace *tempAd = new AddrSpace();
 
     Thread *t = new Thread("ForksThread");
     t->space = tempAd;
     tempAd->getPCB()->setThread(t);
 
+    pagingLock->Acquire();		// no page may be in transit
     currentThread->space->copyMemory(tempAd);
+    pagingLock->Release();
 
     //if there isn't enough memory for the child process, check will return false, and fork will quit
     if (!tempAd->check()) {
-        machine->WriteRegister(2, -1);
-        return -1;
+        pcb *child = tempAd->getPCB();
+        child->setExited(-1);
+        tempAd->setPCB(NULL);
+        currentThread->space->getPCB()->reapChild(child);
+        delete tempAd;
+        delete t;
+        *result = -1;
+        return TRUE;
     }
 
     memLock->Acquire();
     oldPC = machine->ReadRegister(PCReg);
     oldPrevPC = machine->ReadRegister(PrevPCReg);
     oldNextPC = machine->ReadRegister(NextPCReg);
-    index = oldPC;
     machine->WriteRegister(PCReg, machine->ReadRegister(4));
     machine->WriteRegister(PrevPCReg, machine->ReadRegister(4) - 4);
     machine->WriteRegister(NextPCReg, machine->ReadRegister(4) + 4);
 
     tempAd->SaveReg();
+
+    // the child runs on half of the parent's tickets
+    if (currentThread->tickets > 1) {
+        t->tickets = currentThread->tickets / 2;
+        tempAd->getPCB()->setLentTickets(t->tickets);
+        scheduler->SetTickets(currentThread, currentThread->tickets - t->tickets);
+    } else {
+        t->tickets = 1;
+    }
     t->Fork(helpFork, 1);
 
     machine->WriteRegister(PCReg, oldPC);
     machine->WriteRegister(PrevPCReg, oldPrevPC);
     machine->WriteRegister(NextPCReg, oldNextPC);
 
-    printf("Process [%d] Fork: start at address [0x%x] with [%d] pages memory\n", currentThread->space->getPID(), machine->ReadRegister(4), currentThread->space->getNumPages());
+    DEBUG('S', "Process [%d] Fork: start at address [0x%x] with [%d] pages memory\n", currentThread->space->getPID(), machine->ReadRegister(4), currentThread->space->getNumPages());
 
 
     currentThread->space->RestoreReg();
 
-    machine->WriteRegister(2, tempAd->getPID());
+    *result = tempAd->getPID();
     memLock->Release();
-    return tempAd->getPID();
+    return TRUE;
 }
 
 
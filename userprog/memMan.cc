@@ -1,38 +1,92 @@
 #include "memMan.h"
+#include "system.h"
 
-memMan:: memMan()
+memMan:: memMan(int frames)
 {
     int i;
-    for(i=0; i<32; i++)
+    size = frames;
+    frameMap = new BitMap(size);
+    nextFree = new int[size];
+    refCount = new int[size];
+
+    //push the frames in reverse, so they are handed out from frame 0 up
+    freeHead = -1;
+    for(i=size-1; i>=0; i--)
     { 
-	mem[i]=false;
+	nextFree[i] = freeHead;
+	freeHead = i;
     }
+    numFree = size;
+}
+
+memMan:: ~memMan()
+{
+    delete frameMap;
+    delete [] nextFree;
+    delete [] refCount;
 }
 
 int memMan:: allocate()
+{
+    int i = freeHead;
+
+    if(i == -1)
+	return -1;
+    freeHead = nextFree[i];
+    numFree--;
+    frameMap->Mark(i);
+    refCount[i] = 1;
+    machine->InvalidateFrame(i);	// new owner, new contents
+    return i;
+}
+
+bool memMan:: allocateBatch(int count, int *frames)
 {
     int i;
-    for(i=0; i<32; i++)
-    {
-	if(mem[i]==false)
-	{
-	    mem[i]=true;
-	    numPages++;
-        pageIndex++;
-	    return i;
-	}
-    }
-    return -1;
+
+    if(count > numFree)
+	return false;
+    for(i=0; i<count; i++)
+	frames[i] = allocate();
+    return true;
 }
 
 void memMan:: deallocate(int pageNum)
 {
-    mem[pageNum]=false;
-    numPages--;
-    pageIndex--;
+    ASSERT((pageNum >= 0) && (pageNum < size));
+    ASSERT(frameMap->Test(pageNum));	// freeing a frame twice?
+    if(--refCount[pageNum] > 0)
+	return;				// still shared
+    frameMap->Clear(pageNum);
+    nextFree[pageNum] = freeHead;
+    freeHead = pageNum;
+    numFree++;
+}
+
+void memMan:: share(int pageNum)
+{
+    ASSERT((pageNum >= 0) && (pageNum < size) && frameMap->Test(pageNum));
+    refCount[pageNum]++;
+}
+
+int memMan:: refs(int pageNum)
+{
+    ASSERT((pageNum >= 0) && (pageNum < size) && frameMap->Test(pageNum));
+    return refCount[pageNum];
 }
 
 int memMan:: getPages()
 {
-    return (NumPhysPages-numPages);
+    return numFree;
+}
+
+bool memMan:: inUse(int pageNum)
+{
+    return frameMap->Test(pageNum);
+}
+
+void memMan:: Print()
+{
+    printf("%d of %d frames free\n", numFree, size);
+    frameMap->Print();
 }
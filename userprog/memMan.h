@@ -1,16 +1,46 @@
+#ifndef MEMMAN_H
+#define MEMMAN_H
+
 #include "machine.h"
+#include "bitmap.h"
+
+// memMan keeps track of which physical page frames are in use.
+//
+// The free frames are kept on a stack threaded through "nextFree" (the
+// entry for a free frame holds the next free frame, or -1), so
+// allocate, deallocate and getPages are O(1) no matter how many frames
+// there are.  The bitmap mirrors the stack, one bit per frame, so that
+// deallocate can check it is handed a frame that is really in use, and
+// so that other code can ask about a frame without walking the stack.
+//
+// Frames can be shared between address spaces (copy-on-write Fork), so
+// each frame has a reference count: allocate sets it to one, share adds
+// one, and deallocate only puts the frame back when it drops to zero.
 class memMan
 {
     public:
 
-	memMan();
-	int allocate();
-	void deallocate(int pageNum);
-	int getPages();
+	memMan(int frames);	// manage "frames" physical page frames
+	~memMan();
+	int allocate();		// a free frame, or -1 if there is none
+	bool allocateBatch(int count, int *frames);
+				// fill in "count" free frames, or take
+				// none at all and return false
+	void deallocate(int pageNum);	// drop one reference to a frame
+	void share(int pageNum);	// add a reference to a used frame
+	int refs(int pageNum);		// number of references to a frame
+	int getPages();		// number of free frames
+	bool inUse(int pageNum);
+	void Print();		// print the frame bitmap, for debugging
  
     private:
-    	bool mem[32];
-	int numPages;
-    int pageIndex;
+	BitMap *frameMap;	// bit i is set if frame i is in use
+	int *refCount;		// references to each frame in use
+	int *nextFree;		// free frame stack, linked through frames
+	int freeHead;		// top of the free stack, or -1
+	int numFree;		// frames on the free stack
+	int size;		// number of frames managed
 
 };
+
+#endif
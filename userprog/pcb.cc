@@ -6,21 +6,28 @@ pcb::pcb(Thread *input)
     int i;
     
    processID = pid_manager->getPid();
-    parent_process = NULL;
+    parentID = -1;
     processThread = input;
-    children = new pcbManager();
-    childExitValue=0;
+    firstChild = nextSibling = prevSibling = NULL;
+    numChildren = 0;
+    exited = false;
+    exitStatus = 0;
+    childLock = new Lock("child lock");
+    childExited = new Condition("child exited");
+    killPending = false;
+    syscallStats = NULL;
+    lentTickets = 0;
     MAX_FILES = 21;
 
 
 }
 
+// The thread is not ours to destroy: a zombie's thread is long gone
+// by the time its parent reaps it (see exitProcess and syscallKill).
 pcb:: ~pcb()
 {
-	int i,id;
-        //sets the thread to be destoryed on the next threads run
-	scheduler->setThreadDestroy(processThread);
-
+    delete childExited;
+    delete childLock;
 }
 
 int pcb:: getID()
@@ -41,25 +48,39 @@ void pcb:: setAddrSpace(AddrSpace* input)
 
 void pcb::setParent(pcb * p) 
 {
-    parent_process = p;
+    parentID = (p != NULL) ? p->getID() : -1;
 }
 
 pcb * pcb::getParent() 
 {
-    return parent_process;
+    if (parentID == -1)
+	return NULL;
+    return pcbMan->getThisPCB(parentID);	// NULL once the parent is gone
 }
 
 void pcb::addChild(pcb * c) 
 {
-
-    children->assignPCB(c);
+    c->prevSibling = NULL;
+    c->nextSibling = firstChild;
+    if (firstChild != NULL)
+	firstChild->prevSibling = c;
+    firstChild = c;
     numChildren++;
-
 }
 
 void pcb:: removeChild(int idNum)
 {
-    children->removePCB(idNum);
+    pcb *c = pcbMan->getThisPCB(idNum);
+
+    if (c == NULL || c->parentID != processID)
+	return;
+    if (c->prevSibling != NULL)
+	c->prevSibling->nextSibling = c->nextSibling;
+    else
+	firstChild = c->nextSibling;
+    if (c->nextSibling != NULL)
+	c->nextSibling->prevSibling = c->prevSibling;
+    c->nextSibling = c->prevSibling = NULL;
     numChildren--;
 }
 
@@ -76,25 +97,164 @@ int pcb:: numberChildren()
 
 bool pcb:: checkForChild(int id)
 {
-    return children->validPID(id);
+    pcb *c = pcbMan->getThisPCB(id);
+
+    return (c != NULL) && (c->parentID == processID);
 }
 
-int pcb:: getChildExitValue()
+// Forget all the children at once.  The ones that have already exited
+// are reaped, since nobody is left to Join them; the rest are told
+// they have no parent, so that they reap themselves when they exit.
+void pcb:: setParentsNull()
 {
-    return childExitValue;
+    pcb *c, *next;
+
+    for (c = firstChild; c != NULL; c = next) {
+	next = c->nextSibling;
+	c->nextSibling = c->prevSibling = NULL;
+	c->parentID = -1;
+	if (c->exited) {
+	    pcbMan->removePCB(c->processID);
+	    pid_manager->removePid(c->processID);
+	    delete c;
+	}
+    }
+    firstChild = NULL;
+    numChildren = 0;
 }
 
-void pcb:: setChildExitValue(int input)
+//----------------------------------------------------------------------
+// pcb::setExited
+// 	Record that this process has finished with "status", and wake up
+//	the parent if it is waiting in Join.  The pcb is left in the
+//	process table, so that the parent can still find it by id.
+//----------------------------------------------------------------------
+
+void pcb:: setExited(int status)
 {
-    childExitValue = input;
+    pcb *parent = getParent();
+
+    exited = true;
+    exitStatus = status;
+    processThread = NULL;
+    AdSpace = NULL;
+    if (parent != NULL) {
+	parent->childLock->Acquire();
+	parent->childExited->Broadcast(parent->childLock);
+	parent->childLock->Release();
+    }
 }
 
-void pcb:: setParentsNull()
+bool pcb:: hasExited()
+{
+    return exited;
+}
+
+int pcb:: getExitStatus()
+{
+    return exitStatus;
+}
+
+//----------------------------------------------------------------------
+// pcb::waitForChild
+// 	Sleep until child "id" has exited, then reap it and return its
+//	exit status in "*status".  Returns false if "id" is not one of
+//	our children.  Also returns false, early, if we are killed
+//	meanwhile.
+//----------------------------------------------------------------------
+
+bool pcb:: waitForChild(int id, int *status)
+{
+    pcb *c = pcbMan->getThisPCB(id);
+
+    if (c == NULL || c->parentID != processID)
+	return false;
+
+    childLock->Acquire();
+    while (!c->exited && !killPending)
+	childExited->Wait(childLock);
+    childLock->Release();
+    if (!c->exited)
+	return false;
+
+    *status = c->exitStatus;
+    reapChild(c);
+    return true;
+}
+
+//----------------------------------------------------------------------
+// pcb::waitForAnyChild
+// 	Sleep until one of our children has exited, and return its id;
+//	the child is not reaped, so Join on that id returns its status
+//	straight away.  Returns -1 if we have no children (or are killed
+//	while waiting).
+//----------------------------------------------------------------------
+
+int pcb:: waitForAnyChild()
+{
+    pcb *c = NULL;
+
+    childLock->Acquire();
+    while (numChildren > 0 && !killPending) {
+	for (c = firstChild; c != NULL && !c->exited; c = c->nextSibling)
+	    ;
+	if (c != NULL)
+	    break;
+	childExited->Wait(childLock);
+    }
+    childLock->Release();
+
+    if (c == NULL || killPending)
+	return -1;
+    return c->processID;
+}
+
+// Unlink an exited child and give back its id.
+void pcb:: reapChild(pcb * c)
+{
+    ASSERT(c->exited && c->parentID == processID);
+    removeChild(c->processID);
+    pcbMan->removePCB(c->processID);
+    pid_manager->removePid(c->processID);
+    delete c;
+}
+
+// Kill only marks its victim, which exits by itself on its way back
+// to user code (see syscallKill).  If it is waiting for a child, it
+// is woken up, so that it gets there.
+void pcb:: requestKill()
+{
+    killPending = true;
+    childLock->Acquire();
+    childExited->Broadcast(childLock);
+    childLock->Release();
+}
+
+bool pcb:: killRequested()
 {
-    children->setParentNull();
+    return killPending;
 }
 
 Thread* pcb:: returnThread()
 {
     return processThread;
 }
+
+// The figures belong to stats, not to us, so that they can still be
+// printed after the process is gone.
+SyscallStats* pcb:: getSyscallStats()
+{
+    if (syscallStats == NULL)
+	syscallStats = stats->NewProcess(processID);
+    return syscallStats;
+}
+
+void pcb:: setLentTickets(int n)
+{
+    lentTickets = n;
+}
+
+int pcb:: getLentTickets()
+{
+    return lentTickets;
+}
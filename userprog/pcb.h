@@ -6,6 +6,7 @@ class Thread;
 
 #include "../threads/synch.h"
 class Lock;
+class Condition;
 
 
 #include "addrspace.h"
@@ -14,6 +15,9 @@ class AddrSpace;
 #include "pcbManager.h"
 class pcbManager;
 
+#include "../machine/stats.h"
+class SyscallStats;
+
 
 class pcb {
     public:
@@ -29,10 +33,19 @@ class pcb {
 	bool checkForChild(int id);
 	pcb * getParent();
 	int numberChildren();
-	void setChildExitValue(int input);
-	int getChildExitValue();
 	void setParentsNull();
+	void setExited(int status);	// a zombie until the parent reaps it
+	bool hasExited();
+	int getExitStatus();
+	bool waitForChild(int id, int *status);
+	int waitForAnyChild();
+	void reapChild(pcb * c);
+	void requestKill();		// see syscallKill
+	bool killRequested();
 	Thread* returnThread();
+	SyscallStats* getSyscallStats();	// created on first use
+	void setLentTickets(int n);	// see syscallFork
+	int getLentTickets();
 
 	
     private:
@@ -41,10 +54,21 @@ class pcb {
 	Thread *processThread;
 	AddrSpace *AdSpace;
 	int processID;
-	pcb * parent_process;
-	pcbManager * children;
+	int parentID;		// process id of the parent, or -1; looked
+				// up when needed, so a parent that exits
+				// orphans its children without touching them
+	pcb * firstChild;	// children, in a list linked through
+	pcb * nextSibling;	// the children's pcbs
+	pcb * prevSibling;
 	int numChildren;
-    int childExitValue;	
+	bool exited;		// set by Exit and Kill; the pcb stays in
+	int exitStatus;		// pcbMan until the parent Joins it
+	Lock *childLock;	// the parent sleeps on childExited until
+	Condition *childExited;	// one of its children exits
+	bool killPending;	// killed; exits at its next chance
+    SyscallStats *syscallStats;	// this process's system call figures
+	int lentTickets;	// tickets the parent gave up at Fork, and
+				// gets back when we exit
 };
 
 #endif
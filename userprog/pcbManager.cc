@@ -1,73 +1,59 @@
 #include "pcbManager.h"
+#include "pid.h"
 
 pcbManager:: pcbManager() 
 {
     int i=0;
     pcb_count = 0;
-    for(i=0; i<32; i++)
+    size = 32;
+    pcbArray = new pcb*[size];
+    for(i=0; i<size; i++)
     {
-	usage[i]=false; 
+	pcbArray[i]=NULL;
     }
 }
 
-void pcbManager:: assignPCB(pcb *input)
+pcbManager:: ~pcbManager()
 {
-    int i=0;
-    for(i=0; i<32; i++)
-    {
-	if(usage[i] == false)
-	{
-	    DEBUG('g',"pcbManager.cc pcb has been assigned\n");
-	    pcbArray[i] = input;
-	    usage[i]=true;
-	    pcb_count++;
-        currPid = i;
-	    break;
-	}
-    } 
+    delete [] pcbArray;
 }
 
-void pcbManager:: removePCB(int pid)
+void pcbManager:: assignPCB(pcb *input)
 {
-    int i=0;
-    for(i=0; i<32; i++)
+    int i;
+    int slot = PidSlot(input->getID());
+
+    if(slot >= size)
     {
-	if((usage[i]==true) && (pcbArray[i]->getID() == pid))
-	{
-		pcbArray[i] = NULL;
-		usage[i] = false;
-     		pcb_count--;
-		break;
-        }
-     }
+	//grow the table to cover the new slot
+	int newSize = size;
+	while(newSize <= slot)
+	    newSize *= 2;
+	pcb **bigger = new pcb*[newSize];
+	for(i=0; i<newSize; i++)
+	    bigger[i] = (i < size) ? pcbArray[i] : NULL;
+	delete [] pcbArray;
+	pcbArray = bigger;
+	size = newSize;
+    }
+    ASSERT(pcbArray[slot] == NULL);
+    DEBUG('g',"pcbManager.cc pcb has been assigned\n");
+    pcbArray[slot] = input;
+    pcb_count++;
 }
 
-bool pcbManager:: validPID(int pid)
+void pcbManager:: removePCB(int pid)
 {
-    int i=0;
-    for(i=0; i<32; i++)
+    if(getThisPCB(pid) != NULL)
     {
-	if((pcbArray[i]!=NULL) && (pcbArray[i]->getID() == pid))
-	{
-        currPid = i;
-	    return true;
-	}
-    } 
-    return false;
+	pcbArray[PidSlot(pid)] = NULL;
+	pcb_count--;
+    }
 }
 
-void pcbManager:: setParentNull()
+bool pcbManager:: validPID(int pid)
 {
-    int i;
-    for(i=0; i<32; i++)
-    {
-	if((usage[i]==true) && (pcbArray[i]->getParent() != NULL))
-	{
-		pcbArray[i]->setParent(NULL);
-        currPid = i;
-    	}
-    } 
-
+    return (getThisPCB(pid) != NULL);
 }
 
 int pcbManager:: getNumPCB()
@@ -77,15 +63,10 @@ int pcbManager:: getNumPCB()
 
 pcb* pcbManager:: getThisPCB(int pcbID)
 {
-    int i;
-    for(i=0; i<32; i++)
-    {
-	if((usage[i]==true) && (pcbArray[i]->getID() == pcbID))
-	{
-	    currPid = i;
-        return pcbArray[i];
-	    break;
-	}
-    }
-    return NULL;
+    int slot = PidSlot(pcbID);
+
+    if((pcbID <= 0) || (slot >= size) || (pcbArray[slot] == NULL)
+	    || (pcbArray[slot]->getID() != pcbID))
+	return NULL;
+    return pcbArray[slot];
 }
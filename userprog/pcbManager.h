@@ -4,22 +4,25 @@
 #include "pcb.h"
 class pcb;
 
+// pcbManager is the process table: pcbs are kept in the slot given by
+// their process id (see pid.h), so lookup, insert and remove are O(1).
+// Lookups compare the whole id, generation included, so a stale id
+// never finds the process that has since reused its slot.
 class pcbManager
 {
 
     public: 
 	pcbManager();
+	~pcbManager();
 	void assignPCB(pcb *input);
 	void removePCB(int pid);
 	int getNumPCB();
 	bool validPID(int pid); 
-	void setParentNull();
-	pcb* getThisPCB(int pcbID);
+	pcb* getThisPCB(int pcbID);	// NULL if there is no such process
 
     private:
-    	pcb *pcbArray[32];
-	bool usage[32];
+    	pcb **pcbArray;		// pcbArray[PidSlot(id)] is process "id"
+	int size;		// number of slots; grows on demand
 	int pcb_count;
-    int currPid;
 };
 #endif
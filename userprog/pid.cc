@@ -1,30 +1,82 @@
 #include "pid.h"
+#include "system.h"
 
 pid::pid()
 {
-    int i;
-    for(i=1; i<32; i++) 
-    {
-	ids[i] = false;
-    }
+    size = 32;
+    generation = new int[size];
+    live = new bool[size];
+    nextFree = new int[size];
+    highWater = 1;		//slot 0 is never used, ids start at 1
+    freeHead = freeTail = -1;
+}
+
+pid::~pid()
+{
+    delete [] generation;
+    delete [] live;
+    delete [] nextFree;
 }
 
 int pid::getPid()
 {
     int i;
 
-    for(i=1; i<32; i++)
+    if(highWater == size && freeHead == -1)
     {
-	if(ids[i] == false)
+	//every slot is live, double the table
+	ASSERT(2 * size <= PidSlotMask + 1);
+	int *biggerGen = new int[2 * size];
+	bool *biggerLive = new bool[2 * size];
+	int *biggerNext = new int[2 * size];
+	for(i=1; i<size; i++)
 	{
-	    ids[i] = true;
-	    return i;
+	    biggerGen[i] = generation[i];
+	    biggerLive[i] = live[i];
 	}
+	delete [] generation;
+	delete [] live;
+	delete [] nextFree;
+	generation = biggerGen;
+	live = biggerLive;
+	nextFree = biggerNext;
+	size *= 2;
+    }
+
+    if(highWater < size)
+    {
+	i = highWater++;
+	generation[i] = 0;
+    }
+    else
+    {
+	i = freeHead;
+	freeHead = nextFree[i];
     }
-    return -1;
+    live[i] = true;
+    return i | (generation[i] << PidSlotBits);
 }
 
 void pid::removePid(int input)
 {
-    ids[input] = false;
+    int i = PidSlot(input);
+
+    if(!isLive(input))
+	return;
+    live[i] = false;
+    generation[i] = (generation[i] + 1) % PidGenerations;
+    nextFree[i] = -1;
+    if(freeHead == -1)
+	freeHead = i;
+    else
+	nextFree[freeTail] = i;
+    freeTail = i;
+}
+
+bool pid::isLive(int input)
+{
+    int i = PidSlot(input);
+
+    return (input > 0) && (i < highWater) && live[i]
+		&& ((input >> PidSlotBits) == generation[i]);
 }
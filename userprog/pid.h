@@ -1,10 +1,35 @@
+#ifndef PID_H
+#define PID_H
+
+// Process ids are generation-tagged: the low PidSlotBits bits pick a
+// slot in the process table, and the bits above count how many times
+// the slot has been reused.  A slot's first id is just the slot
+// number, but once a process exits, an id that refers to it can never
+// match the next process to use the same slot.
+#define PidSlotBits	20
+#define PidSlotMask	((1 << PidSlotBits) - 1)
+#define PidGenerations	(1 << (31 - PidSlotBits))	// keeps ids positive
+#define PidSlot(id)	((id) & PidSlotMask)
+
+// pid hands out process ids.  Slots are taken fresh until the table is
+// full, then recycled oldest-freed first; the table doubles when every
+// slot is live.  getPid and removePid are O(1).
 class pid
 {
     public:
 	pid();
+	~pid();
 	int getPid();
-	void removePid(int input);
+	void removePid(int input);	// ignores ids that aren't live
+	bool isLive(int input);		// is "input" a current process id?
     private:
-	bool ids[32];
+	int *generation;	// current generation of each slot
+	bool *live;		// live[i] is TRUE if slot i is in use
+	int *nextFree;		// queue of freed slots, linked through here
+	int freeHead;		// oldest freed slot, or -1
+	int freeTail;		// newest freed slot
+	int highWater;		// slots below this have been used before
+	int size;		// number of slots; grows on demand
 };
 
+#endif
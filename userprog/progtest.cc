@@ -44,7 +44,7 @@ StartProcess(char *filename) {
     currentThread->space = space;
     space->getPCB()->setThread(currentThread);
 
-    delete executable; // close file
+    // the address space keeps "executable" open, to page from it
 
     space->InitRegisters(); // set the initial register values
     space->RestoreState(); // load page table register
@@ -31,6 +31,9 @@
 #define SC_Fork		9
 #define SC_Yield	10
 #define SC_Kill         11
+#define SC_JoinAny	12
+#define SC_Sleep	13
+#define SC_SetTickets	14
 
 #ifndef IN_ASM
 
@@ -68,10 +71,28 @@ SpaceId Exec(char *name);
  */
 int Join(SpaceId id); 	
 
+/* Only return once some child of this program has finished, and return
+ * its identifier, or -1 if there are no children.  A Join on that
+ * identifier then returns the exit status at once.
+ */
+SpaceId JoinAny();
+
 //adding Kill function
 int Kill(int id);
  
 
+/* Sleep for at least "ticks" units of simulated time, without using the
+ * CPU in the meantime.
+ */
+void Sleep(int ticks);
+
+/* Set the calling process's share of the CPU under the stride scheduler
+ * (nachos -sp stride) to "tickets", from 1 to 10000; a process starts
+ * with 100, or half its parent's.  Returns 0, or -1 if "tickets" is out
+ * of range.
+ */
+int SetTickets(int tickets);
+
 /* File system operations: Create, Open, Read, Write, Close
  * These functions are patterned after UNIX -- files represent
  * both files *and* hardware I/O devices.
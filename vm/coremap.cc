@@ -0,0 +1,165 @@
+// coremap.cc 
+//	Routines to keep track of which virtual pages use each physical
+//	page frame, and to free a frame when memory runs out.  See
+//	coremap.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "coremap.h"
+#include "replace.h"
+#include "swap.h"
+
+//----------------------------------------------------------------------
+// CoreMap::CoreMap
+// 	Initialize the core map for "frames" physical page frames, all
+//	unused.  "replacement" chooses which frame to page out.
+//----------------------------------------------------------------------
+
+CoreMap::CoreMap(int frames, ReplacementPolicy *replacement)
+{
+    size = frames;
+    mappings = new FrameMapping *[size];
+    loadTime = new int[size];
+    for (int i = 0; i < size; i++) {
+	mappings[i] = NULL;
+	loadTime[i] = 0;
+    }
+    loads = 0;
+    policy = replacement;
+}
+
+CoreMap::~CoreMap()
+{
+    FrameMapping *m;
+
+    for (int i = 0; i < size; i++)
+	while ((m = mappings[i]) != NULL) {
+	    mappings[i] = m->next;
+	    delete m;
+	}
+    delete [] mappings;
+    delete [] loadTime;
+    delete policy;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Map
+// 	Record that page "vpn" of "space" uses "frame".  If it is the
+//	first page to do so, the frame has just been filled.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Map(int frame, AddrSpace *space, int vpn)
+{
+    FrameMapping *m = new FrameMapping;
+
+    ASSERT(frame >= 0 && frame < size);
+    if (mappings[frame] == NULL)
+	loadTime[frame] = ++loads;
+    m->space = space;
+    m->vpn = vpn;
+    m->next = mappings[frame];
+    mappings[frame] = m;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Unmap
+// 	Forget that "space" uses "frame".
+//----------------------------------------------------------------------
+
+void
+CoreMap::Unmap(int frame, AddrSpace *space)
+{
+    FrameMapping **link, *m;
+
+    ASSERT(frame >= 0 && frame < size);
+    for (link = &mappings[frame]; (m = *link) != NULL; link = &m->next)
+	if (m->space == space) {
+	    *link = m->next;
+	    delete m;
+	    return;
+	}
+    ASSERT(FALSE);			// it wasn't mapped
+}
+
+bool
+CoreMap::Evictable(int frame)
+{
+    return mappings[frame] != NULL && mappings[frame]->next == NULL
+		&& mans_man->refs(frame) == 1;
+}
+
+TranslationEntry *
+CoreMap::EntryFor(int frame)
+{
+    FrameMapping *m = mappings[frame];
+
+    ASSERT(m != NULL);
+    return &(m->space->getPageTable()[m->vpn]);
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Clean
+// 	Write out up to "want" pages that are dirty but haven't been used
+//	since the replacement policy last looked, so that when they are
+//	chosen as victims they can simply be dropped.  The pages are
+//	written in clusters of up to ClusterPages.  Used by the pageout
+//	daemon.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Clean(int want)
+{
+    int frames[ClusterPages], slots[ClusterPages], n = 0;
+    TranslationEntry *entry;
+    FrameMapping *m;
+
+    for (int frame = 0; frame < size && want > 0; frame++) {
+	if (!Evictable(frame))
+	    continue;
+	entry = EntryFor(frame);
+	if (!entry->dirty || entry->use)
+	    continue;
+	m = mappings[frame];
+	slots[n] = m->space->cleanPage(m->vpn);
+	if (slots[n] == -1)		// swap is full
+	    break;
+	frames[n++] = frame;
+	want--;
+	if (n == ClusterPages) {
+	    swapSpace->WriteCluster(n, slots, frames);
+	    n = 0;
+	}
+    }
+    if (n > 0)
+	swapSpace->WriteCluster(n, slots, frames);
+}
+
+//----------------------------------------------------------------------
+// CoreMap::MakeRoom
+// 	Free up a frame: let the policy pick a victim, and have the
+//	address space that owns it page it out.  A clock policy clears
+//	use bits as it sweeps, so the host TLB has to be flushed, or
+//	later references would hit it and never set them again.  The owner unmaps it and
+//	gives it back to mans_man, so the caller can just allocate again.
+//----------------------------------------------------------------------
+
+bool
+CoreMap::MakeRoom()
+{
+    int frame = policy->ChooseVictim(this);
+    FrameMapping *m;
+
+    machine->FlushHostTLB();		// the policy may have cleared use
+					// bits of the current space's pages
+    if (frame == -1)
+	return FALSE;
+    m = mappings[frame];
+    DEBUG('a', "Evicting page %d of process %d from frame %d\n", m->vpn,
+		m->space->getPID(), frame);
+    return m->space->evictPage(m->vpn);
+}
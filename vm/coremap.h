@@ -0,0 +1,73 @@
+// coremap.h 
+//	Data structures for page replacement.
+//
+//	The core map is the inverse of the page tables: for each physical
+//	page frame, it records which virtual pages are mapped to it.  When
+//	memMan runs out of frames, the core map asks the replacement policy
+//	for a victim frame, and has the address space that owns it page it
+//	out.
+//
+//	A frame normally holds one virtual page.  After a Fork, frames are
+//	shared copy-on-write by parent and child until one of them writes;
+//	such frames are never chosen, since paging them out would mean
+//	giving every sharer its own copy in swap.  Nor are text frames
+//	kept by a ProgramImage for sharing between runs of a program.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef COREMAP_H
+#define COREMAP_H
+
+#include "copyright.h"
+#include "translate.h"
+
+class AddrSpace;
+class ReplacementPolicy;
+
+// One virtual page mapped to a frame.
+
+class FrameMapping {
+  public:
+    AddrSpace *space;			// whose page it is
+    int vpn;				// and which one
+    FrameMapping *next;			// other pages sharing the frame
+};
+
+class CoreMap {
+  public:
+    CoreMap(int frames, ReplacementPolicy *replacement);
+    ~CoreMap();
+
+    void Map(int frame, AddrSpace *space, int vpn);
+					// page "vpn" of "space" now uses
+					// "frame"
+    void Unmap(int frame, AddrSpace *space);
+					// and now it doesn't any more
+
+    bool MakeRoom();			// page out one frame, handing it
+					// back to mans_man; FALSE if no
+					// frame could be paged out
+    void Clean(int want);		// write out up to "want" dirty,
+					// unused pages, leaving them
+					// resident but clean
+
+    // For the replacement policies:
+    int NumFrames() { return size; }
+    bool Evictable(int frame);		// held by exactly one page, and
+					// nothing else?
+    TranslationEntry *EntryFor(int frame);
+					// that page's page table entry
+    int LoadTime(int frame) { return loadTime[frame]; }
+					// when the frame was filled
+
+  private:
+    FrameMapping **mappings;		// pages using each frame
+    int *loadTime;			// value of "loads" when the frame
+    int loads;				// was last filled
+    int size;				// number of frames
+    ReplacementPolicy *policy;		// picks the victim in MakeRoom
+};
+
+#endif // COREMAP_H
@@ -0,0 +1,106 @@
+// pageout.cc 
+//	Routines for the pageout daemon, which pages out ahead of demand
+//	so that page faults find free frames.  See pageout.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "pageout.h"
+
+//----------------------------------------------------------------------
+// PageoutDaemon::PageoutDaemon
+// 	Set the free frame watermarks.  By default the daemon wakes when
+//	fewer than an eighth of the frames are free, and frees up to a
+//	quarter of them.  (With fewer than eight frames, it never wakes.)
+//----------------------------------------------------------------------
+
+PageoutDaemon::PageoutDaemon(int low, int high)
+{
+    int frames = machine->numPhysPages;
+
+    if (low < 0)
+	low = frames / 8;
+    if (high < 0)
+	high = max(frames / 4, low + 1);
+    ASSERT(low < high && high <= frames);
+    lowWater = stats->lowWatermark = low;
+    highWater = stats->highWatermark = high;
+    awake = FALSE;
+    wakeup = new Semaphore("pageout wakeup", 0);
+}
+
+PageoutDaemon::~PageoutDaemon()
+{
+    delete wakeup;
+}
+
+static void
+PageoutThread(int dummy)
+{
+    pageoutDaemon->Run();
+}
+
+void
+PageoutDaemon::Start()
+{
+    Thread *t = new Thread("pageout daemon");
+
+    t->Fork(PageoutThread, 0);
+}
+
+//----------------------------------------------------------------------
+// PageoutDaemon::Check
+// 	Called after a frame is taken: wake the daemon if we are below the
+//	low watermark.  The faulting thread doesn't wait for it; the daemon
+//	runs the next time the CPU is given up.
+//----------------------------------------------------------------------
+
+void
+PageoutDaemon::Check()
+{
+    if (!awake && mans_man->getPages() < lowWater) {
+	awake = TRUE;
+	wakeup->V();
+    }
+}
+
+void
+PageoutDaemon::Run()
+{
+    for (;;) {
+	wakeup->P();
+	Reclaim();
+	awake = FALSE;
+    }
+}
+
+//----------------------------------------------------------------------
+// PageoutDaemon::Reclaim
+// 	Write out, in clusters, enough dirty pages that the frames we are
+//	about to free are likely to be clean; then page out victims until
+//	"highWater" frames are free, or nothing more can be paged out.
+//
+//	This runs under the paging lock, like a page fault, so that a
+//	page being written out can't be chosen again, or faulted back
+//	in, before its frame has been given up.
+//----------------------------------------------------------------------
+
+void
+PageoutDaemon::Reclaim()
+{
+    int want = highWater - mans_man->getPages();
+
+    DEBUG('a', "Pageout daemon: %d frames free, freeing %d\n",
+		mans_man->getPages(), want);
+    stats->numDaemonWakeups++;
+    if (want <= 0)
+	return;
+    pagingLock->Acquire();
+    coreMap->Clean(want);
+    while (mans_man->getPages() < highWater && coreMap->MakeRoom())
+	stats->numDaemonPagesReclaimed++;
+    pagingLock->Release();
+}
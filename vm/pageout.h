@@ -0,0 +1,40 @@
+// pageout.h 
+//	Data structures for the pageout daemon.
+//
+//	The pageout daemon is a kernel thread that keeps some frames free,
+//	so that a page fault can usually just take one instead of first
+//	paging something out.  When a fault leaves fewer than "lowWater"
+//	frames free, the daemon is woken; it writes out dirty pages that
+//	haven't been used lately, in clusters, and then pages out victims
+//	(which, being clean now, cost nothing to drop) until "highWater"
+//	frames are free again.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGEOUT_H
+#define PAGEOUT_H
+
+#include "copyright.h"
+#include "synch.h"
+
+class PageoutDaemon {
+  public:
+    PageoutDaemon(int low, int high);
+					// -1 picks the default watermark
+    ~PageoutDaemon();
+
+    void Start();			// fork the daemon thread
+    void Check();			// wake the daemon, if memory is low
+    void Run();				// the daemon thread's body
+
+  private:
+    void Reclaim();			// bring free frames up to highWater
+
+    int lowWater, highWater;		// free frame watermarks
+    bool awake;				// already woken, not back asleep?
+    Semaphore *wakeup;
+};
+
+#endif // PAGEOUT_H
@@ -0,0 +1,112 @@
+// replace.cc 
+//	Routines implementing the page replacement policies.  See
+//	replace.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "replace.h"
+
+//----------------------------------------------------------------------
+// NewReplacementPolicy
+// 	Make the policy called "name" ("fifo", "clock" or "eclock"), as
+//	given with -rp.  Returns NULL for an unknown name.
+//----------------------------------------------------------------------
+
+ReplacementPolicy *
+NewReplacementPolicy(char *name)
+{
+    if (!strcmp(name, "fifo"))
+	return new FIFOPolicy;
+    if (!strcmp(name, "clock"))
+	return new ClockPolicy;
+    if (!strcmp(name, "eclock"))
+	return new EnhancedClockPolicy;
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// FIFOPolicy::ChooseVictim
+// 	Pick the frame filled longest ago.
+//----------------------------------------------------------------------
+
+int
+FIFOPolicy::ChooseVictim(CoreMap *map)
+{
+    int victim = -1;
+
+    for (int frame = 0; frame < map->NumFrames(); frame++)
+	if (map->Evictable(frame) && (victim == -1 ||
+		map->LoadTime(frame) < map->LoadTime(victim)))
+	    victim = frame;
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// ClockPolicy::ChooseVictim
+// 	Sweep the frames from where we left off, giving each used frame a
+//	second chance by clearing its use bit.  Two full sweeps are enough
+//	to find one, if any frame can be paged out at all.
+//----------------------------------------------------------------------
+
+int
+ClockPolicy::ChooseVictim(CoreMap *map)
+{
+    int n = map->NumFrames();
+    int frame;
+    TranslationEntry *entry;
+
+    for (int i = 0; i < 2 * n; i++) {
+	frame = hand;
+	hand = (hand + 1) % n;
+	if (!map->Evictable(frame))
+	    continue;
+	entry = map->EntryFor(frame);
+	if (!entry->use)
+	    return frame;
+	entry->use = FALSE;
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// EnhancedClockPolicy::ChooseVictim
+// 	Sweep for a frame that is neither used nor dirty, leaving the
+//	bits alone; failing that, sweep for one that is not used, clearing
+//	use bits as we go.  After those two sweeps every use bit is clear,
+//	so repeating them once is sure to find a victim, if there is one.
+//----------------------------------------------------------------------
+
+int
+EnhancedClockPolicy::ChooseVictim(CoreMap *map)
+{
+    int n = map->NumFrames();
+    int frame;
+    TranslationEntry *entry;
+
+    for (int round = 0; round < 2; round++) {
+	for (int i = 0; i < n; i++) {
+	    frame = hand;
+	    hand = (hand + 1) % n;
+	    if (!map->Evictable(frame))
+		continue;
+	    entry = map->EntryFor(frame);
+	    if (!entry->use && !entry->dirty)
+		return frame;
+	}
+	for (int i = 0; i < n; i++) {
+	    frame = hand;
+	    hand = (hand + 1) % n;
+	    if (!map->Evictable(frame))
+		continue;
+	    entry = map->EntryFor(frame);
+	    if (!entry->use)
+		return frame;
+	    entry->use = FALSE;
+	}
+    }
+    return -1;
+}
@@ -0,0 +1,59 @@
+// replace.h 
+//	Page replacement policies: which physical page frame to take away
+//	when memory runs out.
+//
+//	All of them only consider frames that CoreMap::Evictable allows,
+//	and look at the use and dirty bits that Translate sets in the
+//	owning page table entry.
+//
+//	  fifo   -- the frame that was filled longest ago
+//	  clock  -- second chance: sweep the frames, clearing use bits,
+//		    until one is found that hasn't been used since the
+//		    last sweep
+//	  eclock -- enhanced clock: like clock, but prefer frames that
+//		    are also clean, since those needn't be written out
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef REPLACE_H
+#define REPLACE_H
+
+#include "copyright.h"
+#include "coremap.h"
+
+class ReplacementPolicy {
+  public:
+    virtual ~ReplacementPolicy() {}
+    virtual int ChooseVictim(CoreMap *map) = 0;
+					// a frame to page out, or -1
+};
+
+class FIFOPolicy : public ReplacementPolicy {
+  public:
+    int ChooseVictim(CoreMap *map);
+};
+
+class ClockPolicy : public ReplacementPolicy {
+  public:
+    ClockPolicy() { hand = 0; }
+    int ChooseVictim(CoreMap *map);
+
+  private:
+    int hand;				// next frame to look at
+};
+
+class EnhancedClockPolicy : public ReplacementPolicy {
+  public:
+    EnhancedClockPolicy() { hand = 0; }
+    int ChooseVictim(CoreMap *map);
+
+  private:
+    int hand;
+};
+
+extern ReplacementPolicy *NewReplacementPolicy(char *name);
+					// by name (see above), or NULL
+
+#endif // REPLACE_H
@@ -0,0 +1,155 @@
+// swap.cc 
+//	Routines to manage the swap file, where pages go when physical
+//	memory runs out.  See swap.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "swap.h"
+
+//----------------------------------------------------------------------
+// SwapSpace::SwapSpace
+// 	Set up "size" page slots of swap.  The file itself isn't
+//	created until something is paged out, since the file system may
+//	not be up yet, and most runs never need it.
+//----------------------------------------------------------------------
+
+SwapSpace::SwapSpace(int size)
+{
+    numSlots = size;
+    slots = new BitMap(numSlots);
+    file = NULL;
+    failed = FALSE;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::~SwapSpace
+// 	Close the swap file, and remove it; nothing in it outlives us.
+//----------------------------------------------------------------------
+
+SwapSpace::~SwapSpace()
+{
+    if (file != NULL) {
+	delete file;
+	fileSystem->Remove(SwapFileName);
+    }
+    delete slots;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Open
+// 	Create the swap file, if we haven't yet.  Returns FALSE if it
+//	can't be created (for instance, if the Nachos file system can't
+//	hold a file that big).
+//----------------------------------------------------------------------
+
+bool
+SwapSpace::Open()
+{
+    if (file != NULL)
+	return TRUE;
+    if (failed)
+	return FALSE;
+    if (fileSystem->Create(SwapFileName, numSlots * PageSize))
+	file = fileSystem->Open(SwapFileName);
+    if (file == NULL) {
+	printf("Unable to create swap file %s of %d pages\n", SwapFileName,
+		numSlots);
+	failed = TRUE;
+	return FALSE;
+    }
+    DEBUG('a', "Created swap file, %d pages\n", numSlots);
+    return TRUE;
+}
+
+int
+SwapSpace::Allocate()
+{
+    if (!Open())
+	return -1;
+    return slots->Find();
+}
+
+void
+SwapSpace::Free(int slot)
+{
+    ASSERT(slot >= 0 && slot < numSlots && slots->Test(slot));
+    slots->Clear(slot);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Copy
+// 	Give a forked child its own copy of a paged-out page.
+//----------------------------------------------------------------------
+
+int
+SwapSpace::Copy(int slot)
+{
+    char buffer[PageSize];
+    int copy = Allocate();
+
+    if (copy == -1)
+	return -1;
+    file->ReadAt(buffer, PageSize, slot * PageSize);
+    file->WriteAt(buffer, PageSize, copy * PageSize);
+    return copy;
+}
+
+void
+SwapSpace::ReadPage(int slot, int frame)
+{
+    ASSERT(file != NULL && slots->Test(slot));
+    DEBUG('a', "Paging in slot %d to frame %d\n", slot, frame);
+    file->ReadAt(&(machine->mainMemory[frame * PageSize]), PageSize,
+		slot * PageSize);
+    stats->numPageIns++;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::WriteCluster
+// 	Write out the "n" (at most ClusterPages) pages in "frames" to the
+//	matching slots "to".  The pairs are sorted by slot (in place), and
+//	each run of adjacent slots is gathered into a buffer and written
+//	with a single request.  Since Allocate hands out the lowest free
+//	slot, pages given slots together tend to get adjacent ones.
+//----------------------------------------------------------------------
+
+void
+SwapSpace::WriteCluster(int n, int *to, int *frames)
+{
+    char buffer[ClusterPages * PageSize];
+    int i, j, run, tmp;
+
+    ASSERT(file != NULL && n <= ClusterPages);
+    for (i = 1; i < n; i++)
+	for (j = i; j > 0 && to[j - 1] > to[j]; j--) {
+	    tmp = to[j]; to[j] = to[j - 1]; to[j - 1] = tmp;
+	    tmp = frames[j]; frames[j] = frames[j - 1]; frames[j - 1] = tmp;
+	}
+    for (i = 0; i < n; i += run) {
+	for (run = 1; i + run < n && to[i + run] == to[i] + run; run++)
+	    ;
+	for (j = 0; j < run; j++)
+	    bcopy(&(machine->mainMemory[frames[i + j] * PageSize]),
+			&buffer[j * PageSize], PageSize);
+	DEBUG('a', "Writing %d pages to slots %d..%d\n", run, to[i],
+			to[i] + run - 1);
+	file->WriteAt(buffer, run * PageSize, to[i] * PageSize);
+	stats->numDaemonClusterWrites++;
+    }
+    stats->numPageOuts += n;
+    stats->numDaemonPagesCleaned += n;
+}
+
+void
+SwapSpace::WritePage(int slot, int frame)
+{
+    ASSERT(file != NULL && slots->Test(slot));
+    DEBUG('a', "Paging out frame %d to slot %d\n", frame, slot);
+    file->WriteAt(&(machine->mainMemory[frame * PageSize]), PageSize,
+		slot * PageSize);
+    stats->numPageOuts++;
+}
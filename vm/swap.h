@@ -0,0 +1,54 @@
+// swap.h 
+//	Data structures for the backing store of virtual memory.
+//
+//	Pages that are paged out go to a file in the Nachos file system,
+//	divided into page-sized slots.  Each address space keeps track of
+//	the slots holding its own pages (so in effect each process has
+//	its own swap area, carved out of the one file), and a page keeps
+//	its slot until its address space gives it back, so that paging
+//	out a page that hasn't been written since it was paged in costs
+//	nothing.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SWAP_H
+#define SWAP_H
+
+#include "copyright.h"
+#include "filesys.h"
+#include "bitmap.h"
+
+#define SwapFileName	"SWAP"	// the backing store, in the file system
+#define DefaultSwapPages 1024	// slots in it, unless set with -swap
+#define ClusterPages	8	// most pages in one WriteCluster
+
+class SwapSpace {
+  public:
+    SwapSpace(int size);		// "size" pages of swap; the
+					// file is created on first use
+    ~SwapSpace();			// close and remove the swap file
+
+    int Allocate();			// a free slot, or -1 if full
+    void Free(int slot);		// give a slot back
+    int Copy(int slot);			// a new slot holding the same
+					// page as "slot", or -1 if full
+
+    void ReadPage(int slot, int frame);	// page in/out between "slot" and
+    void WritePage(int slot, int frame);// physical page "frame"
+    void WriteCluster(int n, int *to, int *frames);
+					// write out several pages, with
+					// one write per run of adjacent
+					// slots
+
+  private:
+    bool Open();			// make sure the file exists
+
+    OpenFile *file;			// the swap file, or NULL
+    bool failed;			// couldn't create it; don't retry
+    BitMap *slots;			// which slots are in use
+    int numSlots;
+};
+
+#endif // SWAP_H